@@ -0,0 +1,42 @@
+//==============================================================================
+// Асинхронный вывод (OLED_ASYNC) на ПК с эмулятором SSD1306.
+// Рисование только складывает транзакции в очередь и сразу возвращается,
+// а "прерывание таймера" (здесь - обычный цикл) на каждом тике отправляет
+// по одной транзакции через poll(). Между тиками процессор свободен.
+// Сборка: pio run -e native_async && .pio/build/native_async/program
+//------------------------------------------------------------------------------
+
+#define OLED_1306_MINI
+#define OLED_ASYNC
+#define OLED_QUEUE_SIZE 512
+
+#include <Oled1306Mini.hpp>
+#include <Wire.h>
+#include <stdio.h>
+
+OledMini<SSD1306_128x64> oled(0x3C);
+
+static bool done = false;
+static void onDone() { done = true; }
+
+int main(void) {
+  oled.onDone(onDone);
+  oled.init();
+  oled.wait(); // инициализацию дожидаемся целиком
+
+  oled.clear(); // часть очистки уйдет сразу - очередь меньше экрана
+  oled.setScale(2);
+  oled.setCursor(10, 3);
+  done = false;
+  oled.print("Async!");
+  printf("после рисования в очереди остались транзакции: %s\n", oled.busy() ? "да" : "нет");
+
+  unsigned ticks = 0;
+  while (oled.busy()) { // тик таймера: одна транзакция
+    oled.poll();
+    ticks++;
+  }
+  printf("остаток очереди отправлен за %u тиков, onDone %s\n", ticks, done ? "вызван" : "не вызван");
+  Wire.dump(stdout, 64, true);
+  return 0;
+}
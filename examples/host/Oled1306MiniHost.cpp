@@ -0,0 +1,50 @@
+//==============================================================================
+// Oled1306Mini на ПК: вместо железа - эмулятор SSD1306 из extras/host/Wire.h.
+// Рисуем то же, что и на дисплее, и печатаем в консоль картинку экрана
+// и число транзакций/байт, ушедших по шине.
+// Сборка: pio run -e native && .pio/build/native/program
+//------------------------------------------------------------------------------
+
+#define OLED_1306_MINI
+
+#include <Oled1306Mini.hpp>
+#include <Wire.h>
+#include <stdio.h>
+
+OledMini<SSD1306_128x64> oled(0x3C);
+
+// показать экран и сколько стоил вывод с прошлого вызова
+static void show(const char *title) {
+  oled.update();
+  printf("--- %s: %u транзакций, %u байт\n", title, (unsigned)Wire.nTransactions, (unsigned)Wire.nBytes);
+  Wire.dump(stdout, 64, true);
+  Wire.resetStats();
+}
+
+int main(void) {
+  oled.init();
+  Wire.setClock(400000L);
+  oled.clear();
+  show("init + clear");
+
+  oled.home();
+  oled.print("Hello!");
+  oled.setCursor(5, 1);
+  oled.setScale(2);
+  oled.print("Hello!");
+  oled.setCursorXY(15, 30);
+  oled.setScale(3);
+  oled.invertText(true);
+  oled.print("Привет!");
+  show("текст");
+
+  oled.clear();
+  oled.invertText(false);
+  oled.line(0, 63, 127, 0);
+  oled.fastLineH(0, 5, 10);
+  oled.fastLineV(0, 5, 10);
+  oled.rect(20, 20, 30, 25);
+  oled.rect(5, 35, 35, 60, OLED_STROKE);
+  show("графика");
+  return 0;
+}
@@ -0,0 +1,426 @@
+//==============================================================================
+// Замер стоимости вывода Oled1306Mini по шине I2C.
+// Работает на ПК с эмулятором SSD1306 (extras/host/Wire.h): для каждого
+// набора вызовов считает транзакции, байты после адреса, накладные расходы
+// START/адрес/STOP и оценку времени на 100/400/800 кГц.
+//
+//   program               - таблица для человека
+//   program --csv         - то же в CSV
+//   program --save FILE   - записать CSV как базу
+//   program --check FILE  - сравнить с базой; если где-то байт или транзакций
+//                           стало больше или не прошла проверка вывода
+//                           (числа, ошибка шины, с OLED_STATS - счетчики
+//                           против эмулятора) - код возврата 1
+//
+// Сборка: pio run -e bench, база - extras/bench/baseline.csv.
+// База снята без OLED_USE_BUFFER/OLED_PAGE_BUFFER и с WIRE_TX_BUFFER_LENGTH 32.
+// С OLED_I2C_DIRECT (pio run -e bench_direct) - своя база baseline_direct.csv.
+//------------------------------------------------------------------------------
+
+#include <Oled1306Mini.hpp>
+#include <Wire.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_MAX 32
+
+// на каждую транзакцию: START, адрес с ACK (9 бит), STOP
+#define BENCH_OVERHEAD_BITS 11
+
+struct BenchResult {
+  const char *name;
+  unsigned long transactions;
+  unsigned long payload; // байты после адреса, включая управляющие
+};
+
+static OledMini<SSD1306_128x64> oled(0x3C);
+
+static BenchResult results[BENCH_MAX];
+static int resultCount = 0;
+
+static const uint8_t BITMAP[32 * 4] = {
+    0xFF, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x81, 0x41, 0x21, 0x11, 0x09, 0x05, 0x03, 0xFF,
+    0xFF, 0x03, 0x05, 0x09, 0x11, 0x21, 0x41, 0x81, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0xFF,
+    0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0xFF,
+    0xFF, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
+    0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0xFF,
+    0xFF, 0x40, 0x20, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF,
+    0xFF, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x81, 0x82, 0x84, 0x88, 0x90, 0xA0, 0xC0, 0xFF,
+    0xFF, 0xC0, 0xA0, 0x90, 0x88, 0x84, 0x82, 0x81, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xFF,
+};
+
+// те же картинки в OledPack и редкий значок (круг в середине пустого поля)
+// сырым и сжатым с прозрачными дырами - сделаны extras/tools/oledpack.py
+static const uint8_t BITMAP_PACKED[] = {
+    0x20, 0x20, 0x81, 0xFF, 0x37, 0x01, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00,
+    0x80, 0x01, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00,
+    0x80, 0x81, 0x80, 0x01, 0x81, 0x41, 0x40, 0x02, 0x82, 0x21, 0x20, 0x04, 0x84, 0x11, 0x10, 0x08,
+    0x88, 0x09, 0x08, 0x10, 0x90, 0x05, 0x04, 0x20, 0xA0, 0x03, 0x02, 0x40, 0xC0, 0x85, 0xFF, 0x37,
+    0x03, 0x02, 0x40, 0xC0, 0x05, 0x04, 0x20, 0xA0, 0x09, 0x08, 0x10, 0x90, 0x11, 0x10, 0x08, 0x88,
+    0x21, 0x20, 0x04, 0x84, 0x41, 0x40, 0x02, 0x82, 0x81, 0x80, 0x01, 0x81, 0x01, 0x00, 0x00, 0x80,
+    0x01, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x80,
+    0x01, 0x00, 0x00, 0x80, 0x01, 0x00, 0x00, 0x80, 0x81, 0xFF,
+};
+
+static const uint8_t SPARSE[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE0, 0xF8, 0x1C, 0x0C, 0x06, 0x06, 0x06,
+    0xF7, 0x06, 0x06, 0x06, 0x0C, 0x1C, 0xF8, 0xE0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x0F, 0x3F, 0x70, 0x61, 0xC1, 0xC1, 0xC1,
+    0xDF, 0xC1, 0xC1, 0xC1, 0x61, 0x70, 0x3F, 0x0F, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+static const uint8_t SPARSE_PACKED[] = {
+    0x40, 0x20, 0xFF, 0xE1, 0x3C, 0x01, 0x00, 0x00, 0xE0, 0x0F, 0x00, 0x00, 0xF8, 0x3F, 0x00, 0x00,
+    0x1C, 0x70, 0x00, 0x00, 0x0C, 0x61, 0x00, 0x00, 0x06, 0xC1, 0x00, 0x00, 0x06, 0xC1, 0x00, 0x00,
+    0x06, 0xC1, 0x00, 0x00, 0xF7, 0xDF, 0x01, 0x00, 0x06, 0xC1, 0x00, 0x00, 0x06, 0xC1, 0x00, 0x00,
+    0x06, 0xC1, 0x00, 0x00, 0x0C, 0x61, 0x00, 0x00, 0x1C, 0x70, 0x00, 0x00, 0xF8, 0x3F, 0x00, 0x00,
+    0xE0, 0x0F, 0x80, 0x00, 0x00, 0x01, 0xFF, 0xDC,
+};
+
+// довести нарисованное до дисплея: из буфера и из очереди OLED_ASYNC
+static void flush() {
+  oled.update();
+#ifdef OLED_ASYNC
+  oled.wait();
+#endif
+}
+
+// выполнить набор вызовов на чистом экране и запомнить, сколько он стоил
+static void bench(const char *name, void (*work)()) {
+  oled.init();
+  oled.setScale(1);
+  oled.invertText(false);
+  oled.clear();
+  flush();
+  Wire.resetStats();
+  work();
+  flush();
+  if (resultCount < BENCH_MAX)
+    results[resultCount++] = {name, (unsigned long)Wire.nTransactions, (unsigned long)Wire.nBytes};
+}
+
+// оценка времени передачи в микросекундах: 9 бит на байт + накладные расходы
+static unsigned long benchMicros(const BenchResult &r, unsigned long clock) {
+  unsigned long long bits = 9ULL * r.payload + (unsigned long long)BENCH_OVERHEAD_BITS * r.transactions;
+  return (unsigned long)(bits * 1000000ULL / clock);
+}
+
+static void printText(const char *text, uint8_t scale, int y) {
+  oled.setScale(scale);
+  oled.setCursorXY(0, y);
+  oled.print(text);
+}
+
+static void workFill() { oled.fill(0x55); }
+static void workClear() { oled.clear(10, 10, 100, 50); }
+static void workPrint1() { printText("Hello, 12:34", 1, 8); }
+static void workPrint2() { printText("Hello, 12:34", 2, 8); }
+static void workPrint3() { printText("12:34", 3, 8); }
+static void workPrint4() { printText("12:34", 4, 8); }
+static void workPrint1s() { printText("Hello, 12:34", 1, 11); }
+static void workPrint2s() { printText("Hello, 12:34", 2, 11); }
+static void workPrint3s() { printText("12:34", 3, 11); }
+static void workPrint4s() { printText("12:34", 4, 11); }
+// числа: крайние случаи oledFormat()
+static void workIntMin() { oled.printInt(INT32_MIN); }
+static void workIntZeroPad() { oled.printInt(-42, 6, '0'); }
+static void workFixed() { oled.printFixed(-5, 2); }
+
+static void workRectFill() { oled.rect(10, 5, 100, 50, OLED_FILL); }
+static void workRectStroke() { oled.rect(10, 5, 100, 50, OLED_STROKE); }
+static void workLine() {
+  oled.line(0, 63, 127, 0);
+  oled.line(0, 0, 127, 63);
+  oled.line(10, 60, 40, 2);
+  oled.line(120, 10, 3, 30);
+}
+static void workLineV() {
+  for (int x = 0; x < 128; x += 8)
+    oled.fastLineV(x, 3, 60);
+}
+static void workBitmapAligned() { oled.drawBitmap(40, 16, BITMAP, 32, 32); }
+static void workBitmapUnaligned() { oled.drawBitmap(40, 13, BITMAP, 32, 32); }
+static void workPacked() { oled.drawPacked(40, 13, BITMAP_PACKED); }
+static void workSparse() { oled.drawBitmap(32, 16, SPARSE, 64, 32); }
+static void workSparsePacked() { oled.drawPacked(32, 16, SPARSE_PACKED); }
+
+// кадр из примера: текст, точки, линии, прямоугольники, битмап
+static void workDemoFrame() {
+  oled.home();
+  oled.print("Hello!");
+  oled.setCursor(5, 1);
+  oled.setScale(2);
+  oled.print("Hello!");
+  oled.setScale(1);
+  oled.dot(0, 0);
+  oled.line(5, 5, 10, 10);
+  oled.fastLineH(0, 5, 10);
+  oled.fastLineV(0, 5, 10);
+  oled.rect(20, 20, 30, 25);
+  oled.rect(5, 35, 35, 60, OLED_STROKE);
+  oled.drawBitmap(90, 30, BITMAP, 32, 32);
+}
+
+static void printTable() {
+  printf("%-16s %8s %8s %10s %10s %10s %10s\n", "workload", "trans", "payload", "ovh bits", "us@100k", "us@400k", "us@800k");
+  for (int i = 0; i < resultCount; i++) {
+    const BenchResult &r = results[i];
+    printf("%-16s %8lu %8lu %10lu %10lu %10lu %10lu\n", r.name, r.transactions, r.payload,
+           r.transactions * BENCH_OVERHEAD_BITS, benchMicros(r, 100000), benchMicros(r, 400000), benchMicros(r, 800000));
+  }
+}
+
+static void printCsv(FILE *f) {
+  fprintf(f, "workload,transactions,payload_bytes,overhead_bits,us_100k,us_400k,us_800k\n");
+  for (int i = 0; i < resultCount; i++) {
+    const BenchResult &r = results[i];
+    fprintf(f, "%s,%lu,%lu,%lu,%lu,%lu,%lu\n", r.name, r.transactions, r.payload,
+            r.transactions * BENCH_OVERHEAD_BITS, benchMicros(r, 100000), benchMicros(r, 400000), benchMicros(r, 800000));
+  }
+}
+
+// проверка вывода: work() в начале экрана рисует то же, что print(text).
+// Возвращает 1, если нет
+static int expectText(const char *name, void (*work)(), const char *text) {
+  static uint8_t ram[8][132];
+  for (int k = 0; k < 2; k++) {
+    oled.init();
+    oled.clear();
+    oled.home();
+    if (k)
+      oled.print(text);
+    else
+      work();
+    flush();
+    if (!k)
+      memcpy(ram, Wire.ram, sizeof(ram));
+  }
+  if (!memcmp(ram, Wire.ram, sizeof(ram)))
+    return 0;
+  fprintf(stderr, "%s: выведено не \"%s\"\n", name, text);
+  return 1;
+}
+
+static void workFixedPlus() { oled.printFixed(12345, 2, 9, ' ', true); }
+static void workHex() { oled.printHex(0x3C, 4); }
+static void workUInt() { oled.printUInt(4294967295UL); }
+static void workTenDecimals() { oled.printFixed(5, 12); } // decimals больше OLED_DECIMALS_MAX - как 9
+
+// дисплей не ответил: OLED_HW_UNKNOWN, а после восстановления шины текст
+// выводится заново целиком
+// дисплей не принял только команду окна (setCursorXY() шлет ее сразу):
+// следующий вывод должен задать окно заново, а не писать по старому указателю
+static int checkNackWindow() {
+  static uint8_t ram[8][132];
+  for (int k = 0; k < 2; k++) {
+    oled.init();
+    oled.clear();
+    oled.home();
+    oled.print("A");
+    flush();
+    if (k) {
+      Wire.nack = true;
+      oled.setCursorXY(60, 16);
+      flush();
+      Wire.nack = false;
+#ifndef OLED_USE_BUFFER // с буфером курсор окно не шлет
+      if (!(oled.hwState() & OLED_HW_UNKNOWN)) {
+        fprintf(stderr, "nack_window: нет OLED_HW_UNKNOWN после ошибки в команде окна\n");
+        return 1;
+      }
+#endif
+    }
+    oled.setCursorXY(60, 16);
+    oled.print("B");
+    flush();
+    if (!k)
+      memcpy(ram, Wire.ram, sizeof(ram));
+  }
+  if (!memcmp(ram, Wire.ram, sizeof(ram)))
+    return 0;
+  fprintf(stderr, "nack_window: после ошибки в команде окна \"B\" не на месте\n");
+  return 1;
+}
+
+static int checkNack() {
+  int bad = 0;
+  oled.init();
+  oled.clear();
+  oled.home();
+  oled.print("A");
+  flush();
+  Wire.nack = true;
+  oled.setCursor(0, 0);
+  oled.print("BBB");
+  flush();
+  Wire.nack = false;
+  if (!(oled.hwState() & OLED_HW_UNKNOWN)) {
+    fprintf(stderr, "nack: нет OLED_HW_UNKNOWN после ошибки шины\n");
+    bad++;
+  }
+  oled.setCursor(0, 0);
+  oled.print("BBB");
+  flush();
+  if (oled.hwState() & OLED_HW_UNKNOWN) {
+    fprintf(stderr, "nack: OLED_HW_UNKNOWN не сброшен после вывода\n");
+    bad++;
+  }
+  static uint8_t ram[8][132];
+  memcpy(ram, Wire.ram, sizeof(ram));
+  oled.clear();
+  oled.home();
+  oled.print("BBB");
+  flush();
+  if (memcmp(ram, Wire.ram, sizeof(ram))) {
+    fprintf(stderr, "nack: после ошибки шины выведено не \"BBB\"\n");
+    bad++;
+  }
+  return bad + checkNackWindow();
+}
+
+#ifdef OLED_STATS
+// счетчики OLED_STATS сходятся с тем, что насчитал эмулятор шины: в сумме по
+// группам и без чужих групп - только group и OLED_STAT_OTHER (курсор задает
+// окно сразу)
+static int expectStats(const char *name, void (*work)(), uint8_t group) {
+#ifdef OLED_USE_BUFFER
+  group = OLED_STAT_UPDATE; // на шину все уходит из update()
+#endif
+  oled.init();
+  oled.setScale(1);
+  oled.clear();
+  flush();
+  Wire.resetStats();
+  oled.resetStats();
+  work();
+  flush();
+  OledStats st = oled.stats();
+  unsigned long transactions = 0, bytes = 0;
+  int bad = 0;
+  for (uint8_t g = 0; g < OLED_STAT_COUNT; g++) {
+    transactions += st.group[g].transactions;
+    bytes += st.group[g].cmdBytes + st.group[g].dataBytes;
+    if (g != group && g != OLED_STAT_OTHER && st.group[g].transactions) {
+      fprintf(stderr, "%s: транзакции в группе %s\n", name, oled.statName(g));
+      bad++;
+    }
+  }
+  if (!st.group[group].transactions || transactions != Wire.nTransactions || bytes != Wire.nBytes) {
+    fprintf(stderr, "%s: OLED_STATS %lu/%lu (%s %lu), на шине %lu/%lu\n", name, transactions, bytes,
+            oled.statName(group), (unsigned long)st.group[group].transactions,
+            (unsigned long)Wire.nTransactions, (unsigned long)Wire.nBytes);
+    bad++;
+  }
+  return bad;
+}
+#endif
+
+static int checkOutput() {
+  int bad = checkNack();
+#ifdef OLED_STATS
+  bad += expectStats("stats_print", workPrint2, OLED_STAT_PRINT);
+  bad += expectStats("stats_rect", workRectFill, OLED_STAT_RECT);
+  bad += expectStats("stats_fill", workFill, OLED_STAT_FILL);
+#endif
+  bad += expectText("int_min", workIntMin, "-2147483648");
+  bad += expectText("int_zero_pad", workIntZeroPad, "-00042");
+  bad += expectText("fixed", workFixed, "-0.05");
+  bad += expectText("fixed_plus", workFixedPlus, "  +123.45");
+  bad += expectText("hex", workHex, "003C");
+  bad += expectText("uint_max", workUInt, "4294967295");
+  bad += expectText("decimals_max", workTenDecimals, "0.000000005");
+  return bad;
+}
+
+// сравнить с базой. Возвращает число ухудшений
+static int check(const char *path) {
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "нет базы %s\n", path);
+    return 1;
+  }
+  char line[160];
+  int bad = 0;
+  fgets(line, sizeof(line), f); // заголовок
+  while (fgets(line, sizeof(line), f)) {
+    char name[40];
+    unsigned long tr, payload;
+    if (sscanf(line, "%39[^,],%lu,%lu", name, &tr, &payload) != 3)
+      continue;
+    const BenchResult *r = nullptr;
+    for (int i = 0; i < resultCount; i++)
+      if (!strcmp(results[i].name, name))
+        r = &results[i];
+    if (!r) {
+      fprintf(stderr, "%s: нет в замере\n", name);
+      bad++;
+    } else if (r->transactions > tr || r->payload > payload) {
+      fprintf(stderr, "%s: хуже базы (%lu/%lu против %lu/%lu)\n", name, r->transactions, r->payload, tr, payload);
+      bad++;
+    } else if (r->transactions < tr || r->payload < payload) {
+      fprintf(stderr, "%s: лучше базы (%lu/%lu против %lu/%lu) - обновите базу\n", name, r->transactions, r->payload, tr, payload);
+    }
+  }
+  fclose(f);
+  return bad;
+}
+
+int main(int argc, char **argv) {
+  Wire.log = false;
+  bench("fill", workFill);
+  bench("clear_rect", workClear);
+  bench("print_s1", workPrint1);
+  bench("print_s2", workPrint2);
+  bench("print_s3", workPrint3);
+  bench("print_s4", workPrint4);
+  bench("print_s1_shift", workPrint1s);
+  bench("print_s2_shift", workPrint2s);
+  bench("print_s3_shift", workPrint3s);
+  bench("print_s4_shift", workPrint4s);
+  bench("print_int_min", workIntMin);
+  bench("print_zero_pad", workIntZeroPad);
+  bench("print_fixed", workFixed);
+  bench("rect_fill", workRectFill);
+  bench("rect_stroke", workRectStroke);
+  bench("line", workLine);
+  bench("fastLineV", workLineV);
+  bench("bitmap_aligned", workBitmapAligned);
+  bench("bitmap_unaligned", workBitmapUnaligned);
+  bench("bitmap_packed", workPacked);
+  bench("sparse_raw", workSparse);
+  bench("sparse_packed", workSparsePacked);
+  bench("demo_frame", workDemoFrame);
+
+  if (argc > 2 && !strcmp(argv[1], "--save")) {
+    FILE *f = fopen(argv[2], "w");
+    if (!f)
+      return 1;
+    printCsv(f);
+    fclose(f);
+  } else if (argc > 2 && !strcmp(argv[1], "--check")) {
+    printTable();
+    int bad = check(argv[2]) + checkOutput();
+    if (bad) {
+      fprintf(stderr, "ухудшений: %d\n", bad);
+      return 1;
+    }
+  } else if (argc > 1 && !strcmp(argv[1], "--csv")) {
+    printCsv(stdout);
+  } else {
+    printTable();
+  }
+  return 0;
+}
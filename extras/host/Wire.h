@@ -0,0 +1,245 @@
+//==============================================================================
+// Эмулятор шины I2C и контроллера SSD1306 для сборки на ПК.
+// Подменяет глобальный Wire из WchWire: принимает те же вызовы, разбирает
+// поток команд/данных SSD1306 и складывает картинку в модель GDDRAM.
+// Учитывает управляющие байты 0x00/0x40/0x80/0xC0, режим адресации, окно
+// столбиков/страниц, отражения, инверсию и начальную строку.
+//
+// Подключение: каталог extras/host ставится в пути поиска заголовков раньше
+// WchWire (см. env:native в platformio.ini), дальше все как на железе.
+// После вывода смотрим:
+//   Wire.ram[страница][столбик] - содержимое GDDRAM (columns = 132 - как у SH1106);
+//   Wire.panelPixel(x, y)       - что видно на экране (с отражениями);
+//   Wire.transactions           - лог транзакций (адрес + байты);
+//   Wire.nTransactions, nBytes  - счетчики, сброс - resetStats();
+//   Wire.scrolling              - идет прокрутка, writesWhileScrolling -
+//                                 сколько раз в это время трогали ОЗУ.
+// Рядом лежит ch32v00x.h - функции I2C из SDK для OLED_I2C_DIRECT, которые
+// пишут в тот же эмулятор.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#ifndef WIRE_TX_BUFFER_LENGTH
+#define WIRE_TX_BUFFER_LENGTH 32
+#endif
+
+class TwoWire {
+  public:
+  struct Transaction {
+    uint8_t address;
+    std::vector<uint8_t> bytes;
+  };
+
+  void begin() {}
+  void setClock(uint32_t clock) { this->clock = clock; }
+
+  void beginTransmission(uint8_t address) {
+    _cur.address = address;
+    _cur.bytes.clear();
+    _open = true;
+  }
+
+  size_t write(uint8_t data) {
+    if (!_open || _cur.bytes.size() >= WIRE_TX_BUFFER_LENGTH)
+      return 0;
+    _cur.bytes.push_back(data);
+    return 1;
+  }
+
+  // байт прямо в регистр данных I2C, мимо буфера Wire (так пишет
+  // OLED_I2C_DIRECT через SDK, см. ch32v00x.h): длина транзакции не ограничена
+  void writeRegister(uint8_t data) {
+    if (_open)
+      _cur.bytes.push_back(data);
+  }
+
+  uint8_t endTransmission(bool stop = true) {
+    (void)stop;
+    if (!_open)
+      return 4;
+    _open = false;
+    if (nack)
+      return 2; // адрес не подтвержден - контроллер ничего не получил
+    if (log)
+      transactions.push_back(_cur);
+    nTransactions++;
+    nBytes += _cur.bytes.size();
+    decode(_cur.bytes.data(), _cur.bytes.size());
+    return 0;
+  }
+
+  // ---- модель контроллера ----
+  uint8_t ram[8][132] = {};
+  uint8_t columns = 128;  // столбиков в ОЗУ: 128, у SH1106 - 132
+  uint8_t colOffset = 0;  // столбик ОЗУ, с которого начинается экран (для panelPixel)
+  uint8_t mux = 63; // 0xA8 - число строк - 1
+  uint8_t mode = 2; // после сброса - страничная адресация
+  uint8_t colStart = 0, colEnd = 127, pageStart = 0, pageEnd = 7;
+  uint8_t col = 0, page = 0;
+  uint8_t contrast = 0x7F, startLine = 0, offset = 0;
+  bool flipH = false, flipV = false, invert = false, power = false;
+  bool scrolling = false;        // 0x2F без 0x2E
+  uint8_t scrollCmd = 0;         // 0x26/0x27/0x29/0x2A
+  uint8_t scrollArgs[6] = {};    // его параметры
+  uint8_t areaTop = 0, areaRows = 64; // 0xA3
+  size_t writesWhileScrolling = 0; // данные и адресация во время прокрутки - ошибка
+
+  bool nack = false; // дисплей не отвечает на адрес (для проверки ошибок шины)
+
+  // ---- статистика ----
+  uint32_t clock = 100000;
+  bool log = true;
+  std::vector<Transaction> transactions;
+  size_t nTransactions = 0, nBytes = 0;
+
+  void resetStats() {
+    transactions.clear();
+    nTransactions = nBytes = 0;
+  }
+
+  // пиксель GDDRAM (без учета отражений)
+  bool ramPixel(int x, int y) const { return (ram[y >> 3][x] >> (y & 7)) & 1; }
+
+  // пиксель так, как его видно на экране: отражения, начальная строка,
+  // смещение и инверсия
+  bool panelPixel(int x, int y) const {
+    int row = flipV ? mux - y : y;
+    int line = (row + startLine + offset) & 63;
+    return ramPixel(flipH ? columns - 1 - colOffset - x : colOffset + x, line) ^ invert;
+  }
+
+  // вывести содержимое GDDRAM (panel = false) или экрана псевдографикой
+  void dump(FILE *f = stdout, int rows = 64, bool panel = false) const {
+    for (int y = 0; y < rows; y++) {
+      for (int x = 0; x < 128; x++)
+        fputc((panel ? panelPixel(x, y) : ramPixel(x, y)) ? '#' : '.', f);
+      fputc('\n', f);
+    }
+  }
+
+  // вывести лог транзакций: адрес и байты в hex
+  void dumpLog(FILE *f = stdout) const {
+    for (const Transaction &t : transactions) {
+      fprintf(f, "%02X:", t.address);
+      for (uint8_t b : t.bytes)
+        fprintf(f, " %02X", b);
+      fputc('\n', f);
+    }
+  }
+
+  private:
+  void decode(const uint8_t *b, size_t n) {
+    size_t i = 0;
+    while (i < n) {
+      uint8_t ctrl = b[i++];
+      bool data = ctrl & 0x40;
+      if (ctrl & 0x80) { // Co = 1: один байт, затем снова управляющий
+        if (i < n)
+          data ? putData(b[i++]) : putCommand(b[i++]);
+      } else { // Co = 0: все остальное - данные или команды
+        while (i < n)
+          data ? putData(b[i++]) : putCommand(b[i++]);
+      }
+    }
+  }
+
+  void putData(uint8_t d) {
+    if (scrolling)
+      writesWhileScrolling++;
+    ram[page & 7][col % columns] = d;
+    switch (mode) {
+    case 0: // горизонтальная
+      if (col++ >= colEnd) {
+        col = colStart;
+        if (page++ >= pageEnd)
+          page = pageStart;
+      }
+      break;
+    case 1: // вертикальная
+      if (page++ >= pageEnd) {
+        page = pageStart;
+        if (col++ >= colEnd)
+          col = colStart;
+      }
+      break;
+    default: // страничная
+      if (col < columns - 1)
+        col++;
+      else
+        col = colStart;
+      break;
+    }
+  }
+
+  void putCommand(uint8_t c) {
+    if (_argsLeft) {
+      _args[_argsN++] = c;
+      if (--_argsLeft == 0)
+        runCommand();
+      return;
+    }
+    _cmd = c;
+    _argsN = 0;
+    switch (c) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5:
+    case 0xD9: case 0xDA: case 0xDB:
+      _argsLeft = 1;
+      return;
+    case 0x21: case 0x22: case 0xA3:
+      _argsLeft = 2;
+      return;
+    case 0x29: case 0x2A:
+      _argsLeft = 5;
+      return;
+    case 0x26: case 0x27:
+      _argsLeft = 6;
+      return;
+    }
+    runCommand();
+  }
+
+  void runCommand() {
+    uint8_t c = _cmd;
+    if (scrolling && (c == 0x21 || c == 0x22 || c == 0x20))
+      writesWhileScrolling++;
+    switch (c) {
+    case 0x26: case 0x27: case 0x29: case 0x2A:
+      scrollCmd = c;
+      memcpy(scrollArgs, _args, sizeof(scrollArgs));
+      return;
+    case 0xA3: areaTop = _args[0] & 63; areaRows = _args[1] & 127; return;
+    case 0x2E: scrolling = false; return;
+    case 0x2F: scrolling = true; return;
+    case 0x20: mode = _args[0] & 3; return;
+    case 0x21: colStart = col = _args[0] & 127; colEnd = _args[1] & 127; return;
+    case 0x22: pageStart = page = _args[0] & 7; pageEnd = _args[1] & 7; return;
+    case 0x81: contrast = _args[0]; return;
+    case 0xA8: mux = _args[0] & 63; return;
+    case 0xD3: offset = _args[0] & 63; return;
+    case 0xA0: case 0xA1: flipH = c & 1; return;
+    case 0xC0: flipV = false; return;
+    case 0xC8: flipV = true; return;
+    case 0xA6: case 0xA7: invert = c & 1; return;
+    case 0xAE: case 0xAF: power = c & 1; return;
+    }
+    if (c >= 0x40 && c <= 0x7F)
+      startLine = c & 63;
+    else if (c >= 0xB0 && c <= 0xB7)
+      page = c & 7;
+    else if (c <= 0x0F)
+      col = (col & 0xF0) | c;
+    else if (c >= 0x10 && c <= 0x1F)
+      col = (col & 0x0F) | ((c & 0x0F) << 4);
+  }
+
+  Transaction _cur;
+  bool _open = false;
+  uint8_t _cmd = 0, _args[6] = {}, _argsN = 0, _argsLeft = 0;
+};
+
+inline TwoWire Wire;
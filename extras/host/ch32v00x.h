@@ -0,0 +1,48 @@
+//==============================================================================
+// Часть CH32V003 SDK для сборки на ПК: функции I2C, через которые
+// OLED_I2C_DIRECT пишет в периферийный I2C1 мимо буфера Wire. Байты уходят в
+// тот же эмулятор SSD1306 (Wire.h), транзакция - от START до STOP, без
+// ограничения длины. Wire.nack = true - дисплей не подтверждает адрес.
+//------------------------------------------------------------------------------
+#pragma once
+
+#include "Wire.h"
+
+typedef enum { RESET = 0, SET = !RESET } FlagStatus;
+typedef enum { DISABLE = 0, ENABLE = !DISABLE } FunctionalState;
+typedef enum { NoREADY = 0, READY = !NoREADY } ErrorStatus;
+
+struct I2C_TypeDef {};
+inline I2C_TypeDef _hostI2C1;
+#define I2C1 (&_hostI2C1)
+
+#define I2C_Direction_Transmitter ((uint8_t)0x00)
+#define I2C_FLAG_BUSY ((uint32_t)0x00020000)
+#define I2C_FLAG_TXE ((uint32_t)0x10000080)
+#define I2C_FLAG_AF ((uint32_t)0x10000400)
+#define I2C_EVENT_MASTER_MODE_SELECT ((uint32_t)0x00030001)
+#define I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED ((uint32_t)0x00070082)
+#define I2C_EVENT_MASTER_BYTE_TRANSMITTED ((uint32_t)0x00070084)
+
+inline void I2C_GenerateSTART(I2C_TypeDef *, FunctionalState) {}
+
+inline void I2C_Send7bitAddress(I2C_TypeDef *, uint8_t address, uint8_t) {
+  if (!Wire.nack)
+    Wire.beginTransmission(address >> 1);
+}
+
+inline void I2C_SendData(I2C_TypeDef *, uint8_t data) { Wire.writeRegister(data); }
+
+inline void I2C_GenerateSTOP(I2C_TypeDef *, FunctionalState) { Wire.endTransmission(); }
+
+inline ErrorStatus I2C_CheckEvent(I2C_TypeDef *, uint32_t event) {
+  return event == I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED && Wire.nack ? NoREADY : READY;
+}
+
+inline FlagStatus I2C_GetFlagStatus(I2C_TypeDef *, uint32_t flag) {
+  if (flag == I2C_FLAG_TXE)
+    return SET; // регистр данных освобождается сразу
+  return flag == I2C_FLAG_AF && Wire.nack ? SET : RESET;
+}
+
+inline void I2C_ClearFlag(I2C_TypeDef *, uint32_t) {}
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+# ==============================================================================
+# Конвертер кадров в анимацию OledAnim для OledAnimPlayer из Oled1306Mini.
+# Кадры - несколько картинок (PBM или, с Pillow, PNG) или один GIF:
+#
+#   oledanim.py spin0.pbm spin1.pbm spin2.pbm --name SPINNER > spinner.h
+#   oledanim.py boot.gif -o boot.h
+#
+# Первый кадр хранится целиком, каждый следующий - прямоугольниками байт,
+# которые отличаются от предыдущего кадра (и переход от последнего к первому,
+# чтобы круг не начинался с полного кадра). Соседние изменения склеиваются в
+# один прямоугольник, если лишние байты дешевле нового окна (--window).
+# Байты прямоугольников сжаты OledPack (см. oledpack.py).
+# ------------------------------------------------------------------------------
+import argparse
+import os
+import re
+import sys
+
+from oledpack import c_array, pack_chunks, read_image, to_pages
+
+# сколько байт по шине стоит новое окно: команда окна, конец и начало передачи
+WINDOW_COST = 10
+
+
+def read_frames(paths, threshold):
+    if len(paths) == 1 and paths[0].lower().endswith('.gif'):
+        from PIL import Image, ImageSequence
+        frames = []
+        for img in ImageSequence.Iterator(Image.open(paths[0])):
+            img = img.convert('L')
+            w, h = img.size
+            px = img.load()
+            frames.append((w, h, [[1 if px[x, y] >= threshold else 0 for x in range(w)] for y in range(h)]))
+        return frames
+    return [read_image(p, threshold) for p in paths]
+
+
+# прямоугольники (столбик, страница, ширина, высота) с изменившимися байтами
+def diff_rects(prev, cur, window):
+    width = len(cur[0])
+    spans = []
+    for x in range(width):
+        changed = [p for p in range(len(cur)) if cur[p][x] != prev[p][x]]
+        spans.append((min(changed), max(changed)) if changed else None)
+    rects = []
+    rect = None  # [x0, x1, p0, p1]
+    for x, span in enumerate(spans):
+        if span is None:
+            continue
+        if rect:
+            p0, p1 = min(rect[2], span[0]), max(rect[3], span[1])
+            grown = (x - rect[0] + 1) * (p1 - p0 + 1) - (rect[1] - rect[0] + 1) * (rect[3] - rect[2] + 1)
+            if grown <= span[1] - span[0] + 1 + window:
+                rect = [rect[0], x, p0, p1]
+                continue
+            rects.append(rect)
+        rect = [x, x, span[0], span[1]]
+    if rect:
+        rects.append(rect)
+    return [(x0, p0, x1 - x0 + 1, p1 - p0 + 1) for x0, x1, p0, p1 in rects]
+
+
+def encode_delta(prev, cur, window):
+    rects = diff_rects(prev, cur, window)
+    if len(rects) > 255:
+        sys.exit('в кадре больше 255 прямоугольников')
+    out = [len(rects)]
+    sent = 0
+    for x, p, w, h in rects:
+        stream = [cur[pp][xx] for xx in range(x, x + w) for pp in range(p, p + h)]
+        out += [x, p, w, h] + pack_chunks(stream)
+        sent += len(stream)
+    return out, sent
+
+
+def main():
+    ap = argparse.ArgumentParser(description='кадры -> анимация OledAnim')
+    ap.add_argument('frames', nargs='+')
+    ap.add_argument('-o', '--output', help='файл .h (по умолчанию stdout)')
+    ap.add_argument('--name', help='имя массива (по умолчанию из имени первого файла)')
+    ap.add_argument('--threshold', type=int, default=128, help='порог яркости для PNG/GIF (128)')
+    ap.add_argument('--window', type=int, default=WINDOW_COST,
+                    help='сколько лишних байт выгоднее послать, чем открыть новое окно (%d)' % WINDOW_COST)
+    args = ap.parse_args()
+
+    frames = read_frames(args.frames, args.threshold)
+    width, height = frames[0][0], frames[0][1]
+    if any((w, h) != (width, height) for w, h, _ in frames):
+        sys.exit('кадры разного размера')
+    if width > 128 or height > 64 or len(frames) > 255:
+        sys.exit('не больше 128x64 и 255 кадров')
+    pages = [to_pages(w, h, rows) for w, h, rows in frames]
+
+    key = [pages[0][p][x] for x in range(width) for p in range(len(pages[0]))]
+    data = [width, height, len(frames)] + pack_chunks(key)
+    sent = []
+    for i in range(1, len(frames) + 1):
+        delta, n = encode_delta(pages[i - 1], pages[i % len(frames)], args.window)
+        data += delta
+        sent.append(n)
+
+    name = args.name or re.sub(r'\W', '_', os.path.splitext(os.path.basename(args.frames[0]))[0]).upper()
+    full = width * len(pages[0])
+    text = c_array(name, data, '%dx%d, %d кадров, %d байт; на кадр по шине %d-%d байт вместо %d' % (
+        width, height, len(frames), len(data), min(sent), max(sent), full))
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    sys.stderr.write('%s: %d байт (кадры целиком %d)\n' % (name, len(data), full * len(frames)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+# ==============================================================================
+# Конвертер шрифтов BDF и TTF в OledFont для setFont() из Oled1306Mini.
+# BDF читает сам, TTF/OTF - через Pillow (pip install pillow):
+#
+#   oledfont.py 6x13.bdf --name FONT13 > font13.h
+#   oledfont.py Roboto.ttf --size 16 --chars 32-126,0x401,0x410-0x44F,0x451 > roboto16.h
+#
+# Буквы хранятся столбиками по страницам (как их принимает контроллер), у
+# каждой своя ширина. С --trim пустые столбики по краям букв отрезаются, а
+# между буквами ставится --spacing пустых столбиков (по умолчанию 1): так
+# моноширинный BDF становится пропорциональным. Без --trim ширина буквы -
+# ее шаг из шрифта, и промежуток уже внутри.
+# ------------------------------------------------------------------------------
+import argparse
+import os
+import re
+import sys
+
+from oledpack import c_array
+
+DEFAULT_CHARS = '32-126,0x401,0x410-0x44F,0x451'
+
+
+def parse_chars(spec):
+    codes = []
+    for part in spec.split(','):
+        a, _, b = part.partition('-')
+        a = int(a, 0)
+        codes.extend(range(a, int(b, 0) + 1) if b else [a])
+    return sorted(set(codes))
+
+
+# BDF: {код: (шаг, [строки пикселей высотой ascent + descent])}, высота
+def read_bdf(path):
+    glyphs = {}
+    ascent = descent = None
+    bbox = None
+    with open(path, encoding='latin-1') as f:
+        lines = iter(f.read().splitlines())
+    for line in lines:
+        key, _, rest = line.partition(' ')
+        if key == 'FONTBOUNDINGBOX':
+            bbox = [int(v) for v in rest.split()]
+        elif key == 'FONT_ASCENT':
+            ascent = int(rest)
+        elif key == 'FONT_DESCENT':
+            descent = int(rest)
+        elif key == 'STARTCHAR':
+            code, advance, box, bitmap = -1, 0, None, []
+            for line in lines:
+                key, _, rest = line.partition(' ')
+                if key == 'ENCODING':
+                    code = int(rest.split()[0])
+                elif key == 'DWIDTH':
+                    advance = int(rest.split()[0])
+                elif key == 'BBX':
+                    box = [int(v) for v in rest.split()]
+                elif key == 'BITMAP':
+                    for line in lines:
+                        if line.startswith('ENDCHAR'):
+                            break
+                        bitmap.append(int(line, 16) << (4 * (8 - len(line))) if line else 0)
+                    break
+            if code >= 0 and box:
+                glyphs[code] = (advance, box, bitmap)
+    if ascent is None:
+        ascent, descent = bbox[1] + bbox[3], -bbox[3]
+    height = ascent + descent
+    out = {}
+    for code, (advance, (w, h, xo, yo), bitmap) in glyphs.items():
+        left, right = min(0, xo), max(advance, xo + w)
+        rows = [[0] * (right - left) for _ in range(height)]
+        for r, bits in enumerate(bitmap):
+            y = ascent - (yo + h) + r
+            if 0 <= y < height:
+                for c in range(w):
+                    if bits >> (31 - c) & 1:
+                        rows[y][xo + c - left] = 1
+        out[code] = (advance, rows)
+    return out, height
+
+
+def read_ttf(path, size, codes):
+    try:
+        from PIL import Image, ImageDraw, ImageFont
+    except ImportError:
+        sys.exit('для TTF нужен Pillow (pip install pillow) или BDF')
+    font = ImageFont.truetype(path, size)
+    ascent, descent = font.getmetrics()
+    height = ascent + descent
+    out = {}
+    for code in codes:
+        ch = chr(code)
+        advance = int(round(font.getlength(ch)))
+        box = font.getbbox(ch)
+        width = max(advance, box[2], 1)
+        img = Image.new('1', (width, height), 0)
+        ImageDraw.Draw(img).text((0, 0), ch, font=font, fill=1)
+        px = img.load()
+        out[code] = (advance, [[1 if px[x, y] else 0 for x in range(width)] for y in range(height)])
+    return out, height
+
+
+def main():
+    ap = argparse.ArgumentParser(description='BDF/TTF -> OledFont')
+    ap.add_argument('font')
+    ap.add_argument('-o', '--output', help='файл .h (по умолчанию stdout)')
+    ap.add_argument('--name', help='имя шрифта (по умолчанию из имени файла)')
+    ap.add_argument('--size', type=int, default=16, help='размер TTF в пикселях (16)')
+    ap.add_argument('--chars', default=DEFAULT_CHARS, help='коды: 32-126,0x410-0x44F (%s)' % DEFAULT_CHARS)
+    ap.add_argument('--trim', action='store_true', help='отрезать пустые столбики по краям букв')
+    ap.add_argument('--spacing', type=int, help='промежуток между буквами (с --trim 1, без - 0)')
+    args = ap.parse_args()
+
+    codes = parse_chars(args.chars)
+    if args.font.lower().endswith('.bdf'):
+        glyphs, height = read_bdf(args.font)
+    else:
+        glyphs, height = read_ttf(args.font, args.size, codes)
+    if height > 64:
+        sys.exit('высота %d больше 64' % height)
+    pages = (height + 7) // 8
+    spacing = args.spacing if args.spacing is not None else (1 if args.trim else 0)
+
+    data, offsets, widths, ranges = [], [], [], []
+    missing = []
+    for code in codes:
+        if code not in glyphs:
+            missing.append(code)
+            continue
+        advance, rows = glyphs[code]
+        cols = list(range(len(rows[0])))
+        if args.trim:
+            used = [x for x in cols if any(row[x] for row in rows)]
+            cols = list(range(used[0], used[-1] + 1)) if used else list(range(max(1, advance // 2)))
+        if len(cols) > 255:
+            sys.exit('буква 0x%X шире 255' % code)
+        offsets.append(len(data))
+        widths.append(len(cols))
+        for x in cols:
+            for p in range(pages):
+                b = 0
+                for bit in range(8):
+                    y = p * 8 + bit
+                    if y < height and rows[y][x]:
+                        b |= 1 << bit
+                data.append(b)
+        if ranges and ranges[-1][0] + ranges[-1][1] == code:
+            ranges[-1][1] += 1
+        else:
+            ranges.append([code, 1, len(widths) - 1])
+    if len(data) > 0xFFFF or not widths or len(ranges) > 255:
+        sys.exit('шрифт пустой или не влезает в формат')
+
+    name = args.name or re.sub(r'\W', '_', os.path.splitext(os.path.basename(args.font))[0]).upper()
+    text = c_array(name + '_data', data, '%s: высота %d, %d букв, %d байт' % (
+        os.path.basename(args.font), height, len(widths), len(data)))
+    text += 'static const uint16_t %s_offsets[] = {%s};\n' % (name, ', '.join(map(str, offsets)))
+    text += 'static const uint8_t %s_widths[] = {%s};\n' % (name, ', '.join(map(str, widths)))
+    text += 'static const OledFontRange %s_ranges[] = {%s};\n' % (
+        name, ', '.join('{0x%X, %d, %d}' % tuple(r) for r in ranges))
+    text += 'static const OledFont %s = {%d, %d, %d, %d, %s_ranges, %s_offsets, %s_widths, %s_data};\n' % (
+        name, height, pages, spacing, len(ranges), name, name, name, name)
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    total = len(data) + 2 * len(offsets) + len(widths) + 6 * len(ranges)
+    sys.stderr.write('%s: %d букв, %d байт%s\n' % (
+        name, len(widths), total, ', нет: ' + ' '.join('0x%X' % c for c in missing) if missing else ''))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+# ==============================================================================
+# Конвертер картинок в битмапы для Oled1306Mini.
+# Читает PBM (P1/P4) или, если стоит Pillow, PNG/BMP/GIF и пишет C-массив:
+#   - по умолчанию сжатый OledPack для drawPacked();
+#   - с --raw - несжатый для drawBitmap() (страница за страницей).
+#
+#   oledpack.py logo.png > logo.h
+#   oledpack.py icon.pbm --name ICON --transparent -o icon.h
+#
+# --transparent: длинные (не короче --hole байт) серии нулевых байт
+# становятся прозрачными - drawPacked() не шлет их по шине, а переставляет
+# окно. Дисплей под ними остается как был, поэтому так делают значки, которые
+# рисуются на чистом экране или поверх фона. Без ключа нули рисуются как есть.
+#
+# Формат OledPack (см. OledUnpack в Oled1306Mini.hpp): ширина, высота, затем
+# куски по байтам в порядке столбиков (страницы сверху вниз, столбики слева
+# направо):
+#   0x00-0x7F - n + 1 байт как есть
+#   0x80-0xBF - следующий байт повторить (n & 0x3F) + 3 раз
+#   0xC0-0xFF - (n & 0x3F) + 1 прозрачных байт
+# Сборка: вызвать из extra_scripts PlatformIO или руками перед сборкой.
+# ------------------------------------------------------------------------------
+import argparse
+import os
+import re
+import sys
+
+LITERAL_MAX = 128
+REPEAT_MIN, REPEAT_MAX = 3, 66
+HOLE_MAX = 64
+
+
+def read_pbm(data):
+    # токены заголовка PBM с комментариями
+    pos = 0
+
+    def token():
+        nonlocal pos
+        while True:
+            while data[pos:pos + 1].isspace():
+                pos += 1
+            if data[pos:pos + 1] == b'#':
+                while data[pos:pos + 1] not in (b'\n', b''):
+                    pos += 1
+            else:
+                break
+        start = pos
+        while pos < len(data) and not data[pos:pos + 1].isspace():
+            pos += 1
+        return data[start:pos]
+
+    magic = token()
+    width, height = int(token()), int(token())
+    if magic == b'P4':
+        pos += 1  # один пробельный символ после высоты
+        stride = (width + 7) // 8
+        rows = []
+        for y in range(height):
+            line = data[pos + y * stride:pos + (y + 1) * stride]
+            rows.append([(line[x >> 3] >> (7 - (x & 7))) & 1 for x in range(width)])
+        return width, height, rows
+    if magic == b'P1':
+        bits = [c - 48 for c in data[pos:] if c in (48, 49)]
+        return width, height, [bits[y * width:(y + 1) * width] for y in range(height)]
+    raise ValueError('не PBM P1/P4')
+
+
+def read_image(path, threshold):
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:2] in (b'P1', b'P4'):
+        return read_pbm(data)
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit('для %s нужен Pillow (pip install pillow) или PBM' % path)
+    img = Image.open(path).convert('LA')
+    width, height = img.size
+    px = img.load()
+    # светлое и непрозрачное - горящий пиксель
+    rows = [[1 if px[x, y][1] >= 128 and px[x, y][0] >= threshold else 0 for x in range(width)]
+            for y in range(height)]
+    return width, height, rows
+
+
+# байты страниц: pages[страница][столбик], младший бит - верхний пиксель
+def to_pages(width, height, rows):
+    pages = []
+    for p in range((height + 7) // 8):
+        page = []
+        for x in range(width):
+            b = 0
+            for bit in range(8):
+                y = p * 8 + bit
+                if y < height and rows[y][x]:
+                    b |= 1 << bit
+            page.append(b)
+        pages.append(page)
+    return pages
+
+
+# куски OledPack для байтов stream (без заголовка)
+def pack_chunks(stream, hole=0):
+    out = []
+    literal = []
+
+    def flush():
+        while literal:
+            n = min(len(literal), LITERAL_MAX)
+            out.append(n - 1)
+            out.extend(literal[:n])
+            del literal[:n]
+
+    i = 0
+    while i < len(stream):
+        run = 1
+        while i + run < len(stream) and stream[i + run] == stream[i]:
+            run += 1
+        if hole and stream[i] == 0 and run >= hole:
+            flush()
+            for k in range(0, run, HOLE_MAX):
+                out.append(0xC0 | (min(run - k, HOLE_MAX) - 1))
+        elif run >= REPEAT_MIN:
+            flush()
+            k = 0
+            while run - k >= REPEAT_MIN:
+                n = min(run - k, REPEAT_MAX)
+                out += [0x80 | (n - REPEAT_MIN), stream[i]]
+                k += n
+            literal.extend(stream[i] for _ in range(run - k))
+        else:
+            literal.extend(stream[i:i + run])
+        i += run
+    flush()
+    return out
+
+
+def pack(width, height, pages, hole):
+    stream = [pages[p][x] for x in range(width) for p in range(len(pages))]
+    return [width, height] + pack_chunks(stream, hole)
+
+
+def c_array(name, data, comment):
+    lines = ['// %s' % comment, 'static const uint8_t %s[] = {' % name]
+    for i in range(0, len(data), 16):
+        lines.append('    ' + ', '.join('0x%02X' % b for b in data[i:i + 16]) + ',')
+    lines.append('};')
+    return '\n'.join(lines) + '\n'
+
+
+def main():
+    ap = argparse.ArgumentParser(description='картинка -> битмап Oled1306Mini')
+    ap.add_argument('image')
+    ap.add_argument('-o', '--output', help='файл .h (по умолчанию stdout)')
+    ap.add_argument('--name', help='имя массива (по умолчанию из имени файла)')
+    ap.add_argument('--raw', action='store_true', help='несжатый битмап для drawBitmap()')
+    ap.add_argument('--transparent', action='store_true', help='длинные серии нулей - прозрачные')
+    ap.add_argument('--hole', type=int, default=12, help='с какой длины серия нулей прозрачна (12)')
+    ap.add_argument('--threshold', type=int, default=128, help='порог яркости для PNG (128)')
+    ap.add_argument('--invert', action='store_true', help='инвертировать картинку')
+    args = ap.parse_args()
+
+    width, height, rows = read_image(args.image, args.threshold)
+    if width > 128 or height > 64:
+        sys.exit('%s: %dx%d больше экрана 128x64' % (args.image, width, height))
+    if args.invert:
+        rows = [[1 - b for b in row] for row in rows]
+    pages = to_pages(width, height, rows)
+    name = args.name or re.sub(r'\W', '_', os.path.splitext(os.path.basename(args.image))[0]).upper()
+    raw_size = width * len(pages)
+    if args.raw:
+        data = [b for page in pages for b in page]
+        text = c_array(name, data, '%s: %dx%d, drawBitmap(x, y, %s, %d, %d)' % (
+            os.path.basename(args.image), width, height, name, width, height))
+    else:
+        data = pack(width, height, pages, args.hole if args.transparent else 0)
+        text = c_array(name, data, '%s: %dx%d, OledPack %d байт из %d, drawPacked(x, y, %s)' % (
+            os.path.basename(args.image), width, height, len(data), raw_size, name))
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    sys.stderr.write('%s: %d байт (без сжатия %d)\n' % (name, len(data), raw_size))
+
+
+if __name__ == '__main__':
+    main()
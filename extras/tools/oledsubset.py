@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+# ==============================================================================
+# Набор букв для OLED_FONT_SUBSET из Oled1306Mini: собирает символы строк,
+# которые печатает прошивка, и пишет их в заголовок:
+#
+#   oledsubset.py src -o include/oled_subset.h
+#   oledsubset.py src --strings menu.txt --chars 0123456789.- -o include/oled_subset.h
+#   oledsubset.py src --check include/oled_subset.h
+#
+# и в прошивке (или в build_flags: -D OLED_FONT_SUBSET=\"oled_subset.h\"):
+#
+#   #define OLED_FONT_SUBSET "oled_subset.h"
+#   #include <Oled1306Mini.hpp>
+#
+# Берутся все строковые литералы из файлов исходников (.c .cpp .h .hpp .ino,
+# каталоги - рекурсивно), с --calls - только литералы в вызовах этих функций.
+# Текст, который собирается во время работы (числа, строки из EEPROM), сам
+# не найдется: его символы - через --chars или файлом --strings. OLED_FALLBACK
+# (по умолчанию пробел) добавляется всегда.
+#
+# Буквы из полного шрифта выбирает компилятор, и символ, которого в шрифте
+# нет, - ошибка сборки. С --check ничего не пишется: код возврата 1, если в
+# исходниках есть символы, которых нет в готовом заголовке (устарел).
+# Сборка: вызвать из extra_scripts PlatformIO или руками перед сборкой.
+# ------------------------------------------------------------------------------
+import argparse
+import os
+import re
+import sys
+
+SOURCES = ('.c', '.cpp', '.h', '.hpp', '.ino')
+
+# #include, комментарии, символьные и строковые литералы (с префиксами u8, L, R"(...)")
+TOKENS = re.compile(r'''
+    ^[ \t]*\#[ \t]*include[^\n]* | //[^\n]* | /\*.*?\*/
+  | (?:u8|u|U|L)?R"(?P<delim>[^(\s]*)\((?P<raw>.*?)\)(?P=delim)"
+  | (?:u8|u|U|L)?"(?P<str>(?:\\.|[^"\\\n])*)"
+  | '(?:\\.|[^'\\\n])*'
+''', re.S | re.X | re.M)
+
+ESCAPES = {'n': '\n', 't': '\t', 'r': '\r', '0': '\0', 'a': '\a', 'b': '\b',
+           'f': '\f', 'v': '\v', '\\': '\\', '"': '"', "'": "'", '?': '?'}
+
+
+def unescape(text):
+    def sub(m):
+        s = m.group(1)
+        if s[0] in 'xX':
+            return chr(int(s[1:], 16))
+        if s[0] in 'uU':
+            return chr(int(s[1:], 16))
+        if s[0] in '01234567' and len(s) > 1:
+            return chr(int(s, 8))
+        return ESCAPES.get(s, s)
+    return re.sub(r'\\(x[0-9a-fA-F]+|u[0-9a-fA-F]{4}|U[0-9a-fA-F]{8}|[0-7]{1,3}|.)', sub, text)
+
+
+def literals(text, calls):
+    # (позиция, текст) всех строковых литералов
+    found = []
+    for m in TOKENS.finditer(text):
+        if m.group('raw') is not None:
+            found.append((m.start(), m.group('raw')))
+        elif m.group('str') is not None:
+            found.append((m.start(), unescape(m.group('str'))))
+    if not calls:
+        return [s for _, s in found]
+    # литерал внутри вызова: ближайшая незакрытая скобка перед ним - после имени из calls
+    call = re.compile(r'\b(?:%s)\s*$' % '|'.join(map(re.escape, calls)))
+    code = TOKENS.sub(lambda m: ' ' * len(m.group(0)), text)
+    out = []
+    for pos, s in found:
+        depth = 0
+        for i in range(pos - 1, -1, -1):
+            c = code[i]
+            if c == ')':
+                depth += 1
+            elif c == '(':
+                if depth == 0:
+                    if call.search(code, 0, i):
+                        out.append(s)
+                    break
+                depth -= 1
+            elif c == ';' or c == '{' or c == '}':
+                break
+    return out
+
+
+def sources(paths):
+    for path in paths:
+        if os.path.isdir(path):
+            for root, _, files in os.walk(path):
+                for name in sorted(files):
+                    if name.endswith(SOURCES):
+                        yield os.path.join(root, name)
+        else:
+            yield path
+
+
+def collect(args):
+    chars = set(args.fallback)
+    for path in sources(args.sources):
+        with open(path, encoding='utf-8', errors='replace') as f:
+            for s in literals(f.read(), args.calls.split(',') if args.calls else None):
+                chars.update(s)
+    for path in args.strings or []:
+        with open(path, encoding='utf-8') as f:
+            chars.update(f.read())
+    chars.update(args.chars)
+    return sorted(c for c in chars if ord(c) >= 0x20 and c != '�')
+
+
+def read_subset(path):
+    with open(path, encoding='utf-8') as f:
+        m = re.search(r'#define OLED_SUBSET_CHARS (".*")', f.read())
+    if not m:
+        sys.exit('%s: нет OLED_SUBSET_CHARS' % path)
+    return set(unescape(m.group(1)[1:-1]))
+
+
+def c_string(chars):
+    return '"%s"' % ''.join('\\' + c if c in '"\\' else c for c in chars)
+
+
+def main():
+    ap = argparse.ArgumentParser(description='символы строк прошивки -> OLED_FONT_SUBSET')
+    ap.add_argument('sources', nargs='*', help='файлы и каталоги исходников')
+    ap.add_argument('-o', '--output', help='файл .h (по умолчанию stdout)')
+    ap.add_argument('--strings', action='append', help='файл UTF-8 с текстом, который собирается во время работы')
+    ap.add_argument('--chars', default='', help='дополнительные символы, например 0123456789.-')
+    ap.add_argument('--calls', help='брать литералы только из вызовов: print,OLED_LABEL')
+    ap.add_argument('--fallback', default=' ', help='символ OLED_FALLBACK (пробел)')
+    ap.add_argument('--check', metavar='HEADER', help='проверить готовый заголовок, ничего не писать')
+    args = ap.parse_args()
+
+    chars = collect(args)
+    if args.check:
+        missing = [c for c in chars if c not in read_subset(args.check)]
+        if missing:
+            sys.exit('%s: нет символов %s - перегенерируйте oledsubset.py' % (
+                args.check, ' '.join('%s (0x%X)' % (c, ord(c)) for c in missing)))
+        return
+    if len(chars) > 255:
+        sys.exit('%d символов, больше 255' % len(chars))
+
+    names = ', '.join(args.sources + (args.strings or [])) or 'командной строки'
+    text = '// oledsubset.py: символы из %s\n' % names
+    text += '// символов: %d, буквы выбирает компилятор (#define OLED_FONT_SUBSET)\n' % len(chars)
+    text += '#pragma once\n'
+    text += '#define OLED_SUBSET_CHARS %s\n' % c_string(chars)
+    if args.output:
+        # не трогать файл без изменений, чтобы не пересобирать прошивку
+        old = None
+        if os.path.exists(args.output):
+            with open(args.output, encoding='utf-8') as f:
+                old = f.read()
+        if old != text:
+            with open(args.output, 'w', encoding='utf-8') as f:
+                f.write(text)
+    else:
+        sys.stdout.write(text)
+    sys.stderr.write('OLED_SUBSET_CHARS: символов %d\n' % len(chars))
+
+
+if __name__ == '__main__':
+    main()
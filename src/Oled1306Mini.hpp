@@ -6,13 +6,18 @@
 // и переделки уже GyvOLED привели к созданию библиотеки Oled1306Mini.
 //
 // Возможности и ограничения библиотеки:
-// - Поддержка OLED дисплеев только на SSD1306 и только на аппаратном I2C.
+// - Дисплеи SSD1306 (SSD1306_128x64, _128x32, _96x16, _72x40, _64x48, _64x32)
+//   и SH1106_128x64 - только через буфер, только на аппаратном I2C.
 // - Графика ограничена точками, линиями, прямоугольниками.
-// - для вывода текста только функция print(char *str).
-// - переводы строки и автопереводы не действуют. Ставим курсор в нужную позицию
-//   и вызываем print(). Улезающее за край экрана просто обрежется.
-// - печать только строк. Если нужно печатать число - самостоятельно преобразуем
-//   в строку нужного формата.
+// - для вывода текста функция print(char *str) и печать чисел.
+// - '\r' возвращает в начало строки, '\n' переводит строку, autoPrintln(true)
+//   переносит не влезающий текст, console(true) - лог с прокруткой экрана.
+//   Все это - функция WRAP из OledFeatures (без OLED_1306_MINI); без нее
+//   ставим курсор и вызываем print(), улезающее за край экрана обрежется.
+// - числа печатаются без sprintf() и промежуточной строки: printInt(),
+//   printUInt(), printHex(), printFixed() с шириной, заполнителем и знаком;
+//   OledField - поле фиксированной ширины, перерисовывает только изменившиеся
+//   знакоместа.
 //
 // Возможности, унаследованные от GyverOLED:
 // - Вывод текста
@@ -32,21 +37,200 @@
 //------------------------------------------------------------------------------
 #pragma once
 
-// #define OLED_1306_MINI // Отключает часть функций (экономия ~150 байт)
+// Набор функций задается вторым параметром шаблона OledMini (OledFeatures),
+// эти три макроса - его значения по умолчанию:
+// #define OLED_1306_MINI // Без переносов строк, консоли, roundRect() и circle()
 // #define OLED_NO_PRINT  // Отключить вывод текста на дисплей. Остается только графика
 // #define OLED_NO_RUS    // Отключить русский язык для экономии памяти (освобождает около 400 байт)
+// #define OLED_FALLBACK '?' // Что печатать вместо символов, которых нет в шрифте (по умолчанию пробел, 0 - ничего)
+// #define OLED_FONT_SUBSET "oled_subset.h" // Во флеш только буквы из файла от extras/tools/oledsubset.py
+// #define OLED_USE_BUFFER // Рисовать в буфер в ОЗУ (1024/512 байт), на дисплей отправлять update()
+// #define OLED_PAGE_BUFFER // Рисовать постранично в буфер на 128 байт (цикл firstPage()/nextPage())
+// #define OLED_SHADOW     // Копия ОЗУ дисплея для наложения BUF_ADD/BUF_SUBTRACT без буфера (128 байт на страницу)
+// #define OLED_SHADOW_FIRST 0 // Страницы, для которых держать копию (по умолчанию все)
+// #define OLED_SHADOW_LAST 7  //
+// #define OLED_ASYNC      // Не ждать шину: транзакции копятся в очереди, отправляет их poll()
+// #define OLED_QUEUE_SIZE 128 // Размер очереди OLED_ASYNC в байтах
+// #define OLED_BUS_PANELS 4   // Сколько дисплеев можно подключить к одной OledBus
+// #define OLED_I2C_DIRECT     // Писать в I2C1 функциями SDK CH32V003 мимо буфера Wire: передача любой длины
+// #define OLED_I2C_TIMEOUT 10000 // Сколько опросов флага I2C ждать, прежде чем считать шину сломанной
+// #define OLED_STATS      // Счетчики шины и время вызовов по группам функций: stats(), resetStats()
+// #define OLED_STATS_CLOCK() SysTick->CNT // Чем мерить время для OLED_STATS (по умолчанию SysTick, на ПК - std::chrono, нс)
+// #define OLED_STRETCH2 OLED_STRETCH_SWAR // Как растягивать шрифт для setScale(2), (3), (4):
+// #define OLED_STRETCH3 OLED_STRETCH_SWAR //   OLED_STRETCH_LOOP - побитно в цикле, медленно, без таблиц
+// #define OLED_STRETCH4 OLED_STRETCH_SWAR //   OLED_STRETCH_SWAR - сдвигами и масками, без таблиц
+//                                         //   OLED_STRETCH_NIBBLE - таблица на 16 значений (32 байта)
+//                                         //   OLED_STRETCH_BYTE - таблица на 256 значений (512/1024 байта)
 
 #include <Wire.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(OLED_USE_BUFFER) && defined(OLED_PAGE_BUFFER)
+#error "OLED_USE_BUFFER и OLED_PAGE_BUFFER - выберите что-то одно"
+#endif
+#if defined(OLED_USE_BUFFER) || defined(OLED_PAGE_BUFFER)
+#define OLED_BUFFERED // рисование идет в ОЗУ
+#endif
+
+#ifdef OLED_SHADOW
+#ifdef OLED_USE_BUFFER
+#error "OLED_SHADOW не нужен с OLED_USE_BUFFER - буфер уже хранит весь экран"
+#endif
+#ifndef OLED_SHADOW_FIRST
+#define OLED_SHADOW_FIRST 0
+#endif
+#ifndef OLED_SHADOW_LAST
+#define OLED_SHADOW_LAST 7
+#endif
+static_assert(OLED_SHADOW_FIRST <= OLED_SHADOW_LAST, "OLED_SHADOW_FIRST больше OLED_SHADOW_LAST");
+#endif
+
+#ifdef OLED_ASYNC
+#ifndef OLED_QUEUE_SIZE
+#define OLED_QUEUE_SIZE 128
+#endif
+static_assert(OLED_QUEUE_SIZE > WIRE_TX_BUFFER_LENGTH + 1, "OLED_QUEUE_SIZE меньше одной транзакции");
+#ifndef OLED_BUS_PANELS
+#define OLED_BUS_PANELS 4
+#endif
+#endif
+
+#ifdef OLED_I2C_DIRECT
+#include <ch32v00x.h>
+#ifndef OLED_I2C_TIMEOUT
+#define OLED_I2C_TIMEOUT 10000
+#endif
+
+// Транзакция прямо через периферийный I2C1 (функции SDK): байт из вызова
+// сразу идет в регистр данных, без копии в буфер Wire, поэтому длина
+// передачи не ограничена WIRE_TX_BUFFER_LENGTH - SSD1306 принимает данные
+// одним куском любой длины. Wire.begin() по-прежнему настраивает шину.
+// Ошибка (нет ACK, зависла шина) - остаток транзакции пропускается, stop()
+// возвращает не 0, как Wire.endTransmission()
+struct OledI2C {
+  static inline bool failed = false;
+
+  static void start(uint8_t address) {
+    failed = !waitFlag(I2C_FLAG_BUSY, RESET);
+    if (failed)
+      return;
+    I2C_GenerateSTART(I2C1, ENABLE);
+    if (waitEvent(I2C_EVENT_MASTER_MODE_SELECT)) {
+      I2C_Send7bitAddress(I2C1, address << 1, I2C_Direction_Transmitter);
+      waitEvent(I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED);
+    }
+  }
+
+  // ждем только освобождения регистра данных: байт ложится в него, пока
+  // шина еще передает предыдущий
+  static void write(uint8_t data) {
+    if (failed || !waitFlag(I2C_FLAG_TXE, SET))
+      return;
+    I2C_SendData(I2C1, data);
+  }
+
+  static uint8_t stop() {
+    if (!failed)
+      waitEvent(I2C_EVENT_MASTER_BYTE_TRANSMITTED); // последний байт ушел
+    I2C_GenerateSTOP(I2C1, ENABLE);
+    if (failed)
+      I2C_ClearFlag(I2C1, I2C_FLAG_AF);
+    return failed;
+  }
+
+  private:
+  static bool waitEvent(uint32_t event) {
+    for (uint32_t t = OLED_I2C_TIMEOUT; t; t--)
+      if (I2C_CheckEvent(I2C1, event) != NoREADY)
+        return true;
+    failed = true;
+    return false;
+  }
+
+  static bool waitFlag(uint32_t flag, FlagStatus state) {
+    for (uint32_t t = OLED_I2C_TIMEOUT; t; t--)
+      if (I2C_GetFlagStatus(I2C1, flag) == state)
+        return true;
+    failed = true;
+    return false;
+  }
+};
+#endif
+
+#ifdef OLED_STATS
+#ifndef OLED_STATS_CLOCK
+#ifdef __riscv
+#include <ch32v00x.h>
+// у ядра QingKe V2A в CH32V003 нет mcycle - считаем тиками SysTick (HCLK или
+// HCLK/8, как его настроили; Delay_Us()/Delay_Ms() из SDK его сбрасывают)
+#define OLED_STATS_CLOCK() (SysTick->CNT)
+#else
+#include <chrono>
+#define OLED_STATS_CLOCK() ((uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count())
+#endif
+#endif
+
+// группы функций OLED_STATS
+#define OLED_STAT_PRINT 0  // print(), write(), printInt() и другие числа
+#define OLED_STAT_RECT 1   // rect(), roundRect(), clear(x0, y0, x1, y1)
+#define OLED_STAT_LINE 2   // line(), fastLineH(), fastLineV()
+#define OLED_STAT_BITMAP 3 // drawBitmap(), drawPacked(), drawByte(), drawBytes()
+#define OLED_STAT_FILL 4   // fill(), clear()
+#define OLED_STAT_UPDATE 5 // update(), nextPage()
+#define OLED_STAT_OTHER 6  // остальное: init(), курсор, команды, прокрутка (время не меряется)
+#define OLED_STAT_COUNT 7
+
+// счетчики одной группы. Вложенный вызов (rect() рисует линиями) считается в
+// группе внешнего. Байты - с управляющими 0x00/0x40, без адреса
+struct OledStat {
+  uint32_t calls;        // вызовов
+  uint32_t transactions; // транзакций I2C
+  uint32_t cmdBytes;     // байт в транзакциях команд
+  uint32_t dataBytes;    // байт в транзакциях данных
+  uint16_t splits;       // сколько раз sendByte() резал передачу из-за буфера Wire
+  uint16_t errors;       // ошибок шины (с OLED_ASYNC - в OLED_STAT_OTHER: их видит poll())
+  uint32_t minTime, maxTime, totalTime; // время вызова в тиках OLED_STATS_CLOCK(), среднее - totalTime / calls
+};
+
+struct OledStats {
+  OledStat group[OLED_STAT_COUNT];
+};
+
+inline constexpr const char *_oled_statNames[OLED_STAT_COUNT] = {"print", "rect", "line", "bitmap", "fill", "update", "other"};
+
+#define OLED_STAT(group) StatScope _statScope(*this, group)
+#else
+#define OLED_STAT(group)
+#endif
+
 #define constrain(x, a, b) ((x) < (a) ? (a) : ((x) > (b) ? (b) : (x)))
 #define bitSet(value, bit, bitvalue) ((bitvalue) ? (value) |= (1UL << (bit)) : (value) &= ~(1UL << (bit)))
 #define bitGet(value, bit) (((value) >> (bit)) & 0x01)
 
 // ===== константы =====
-#define SSD1306_128x32 0
-#define SSD1306_128x64 1
+// геометрия дисплея - параметр шаблона OledMini: размеры в пикселях,
+// настройка COM-выводов (0xDA), мультиплексор (0xA8) и столбик ОЗУ
+// контроллера, с которого начинается экран. pageMode - контроллер умеет
+// только страничную адресацию (SH1106)
+template <uint8_t W, uint8_t H, uint8_t COMPINS, uint8_t OFFSET = 0, bool PAGE_MODE = false>
+struct OledGeometry {
+  static constexpr uint8_t width = W;
+  static constexpr uint8_t height = H;
+  static constexpr uint8_t pages = H / 8;
+  static constexpr uint8_t compins = COMPINS;
+  static constexpr uint8_t multiplex = H - 1;
+  static constexpr uint8_t offset = OFFSET;
+  static constexpr bool pageMode = PAGE_MODE;
+};
+
+struct SSD1306_128x64 : OledGeometry<128, 64, 0x12> {};
+struct SSD1306_128x32 : OledGeometry<128, 32, 0x02> {};
+struct SSD1306_96x16 : OledGeometry<96, 16, 0x02> {};
+struct SSD1306_72x40 : OledGeometry<72, 40, 0x12, 28> {};
+struct SSD1306_64x48 : OledGeometry<64, 48, 0x12, 32> {};
+struct SSD1306_64x32 : OledGeometry<64, 32, 0x12, 32> {};
+struct SH1106_128x64 : OledGeometry<128, 64, 0x12, 2, true> {}; // 132 столбика ОЗУ, только с буфером
 
 #define OLED_CLEAR 0
 #define OLED_FILL 1
@@ -55,16 +239,61 @@
 #define BUF_ADD 0
 #define BUF_SUBTRACT 1
 #define BUF_REPLACE 2
+#define BUF_CLEAR 3 // для стирания фигур: как BUF_SUBTRACT, а без фона - нулевой байт
 
 #define BITMAP_NORMAL 0
 #define BITMAP_INVERT 1
+
+#define OLED_TEXT_NONE 0  // без текста, только графика
+#define OLED_TEXT_LATIN 1 // ASCII
+#define OLED_TEXT_RUS 2   // ASCII и кириллица
+
+#if defined(OLED_NO_PRINT)
+#define OLED_TEXT_DEFAULT OLED_TEXT_NONE
+#elif defined(OLED_NO_RUS)
+#define OLED_TEXT_DEFAULT OLED_TEXT_LATIN
+#else
+#define OLED_TEXT_DEFAULT OLED_TEXT_RUS
+#endif
+#ifndef OLED_FALLBACK
+#define OLED_FALLBACK ' ' // вместо символов, которых нет в шрифте, - пустое знакоместо
+#endif
+#ifdef OLED_1306_MINI
+#define OLED_FULL_DEFAULT false
+#else
+#define OLED_FULL_DEFAULT true
+#endif
+
+// набор функций - второй параметр шаблона OledMini. Код выключенных функций
+// в прошивку не попадает, у двух дисплеев в одной прошивке наборы могут быть
+// разными:
+//   OledMini<SSD1306_128x64> big(0x3C); // по умолчанию - из OLED_NO_PRINT, OLED_NO_RUS, OLED_1306_MINI
+//   OledMini<SSD1306_128x32, OledFeatures<OLED_TEXT_LATIN, false, false>> small(0x3D);
+// TEXT - OLED_TEXT_NONE/LATIN/RUS, WRAP - '\r', '\n', autoPrintln() и console(),
+// SHAPES - roundRect() и circle()
+template <uint8_t TEXT = OLED_TEXT_DEFAULT, bool WRAP = OLED_FULL_DEFAULT, bool SHAPES = OLED_FULL_DEFAULT>
+struct OledFeatures {
+  static constexpr uint8_t text = TEXT;
+  static constexpr bool wrap = WRAP;
+  static constexpr bool shapes = SHAPES;
+};
+
+#define OLED_STRETCH_LOOP 0
+#define OLED_STRETCH_SWAR 1
+#define OLED_STRETCH_NIBBLE 2
+#define OLED_STRETCH_BYTE 3
+
+#ifndef OLED_STRETCH2
+#define OLED_STRETCH2 OLED_STRETCH_SWAR
+#endif
+#ifndef OLED_STRETCH3
+#define OLED_STRETCH3 OLED_STRETCH_SWAR
+#endif
+#ifndef OLED_STRETCH4
+#define OLED_STRETCH4 OLED_STRETCH_SWAR
+#endif
 // ============================ БЭКЭНД КОНСТАНТЫ ==============================
 // внутренние константы для настройки дисплея
-#define OLED_WIDTH 128
-#define OLED_HEIGHT_32 0x02
-#define OLED_HEIGHT_64 0x12
-#define OLED_64 0x3F
-#define OLED_32 0x1F
 
 #define OLED_DISPLAY_OFF 0xAE
 #define OLED_DISPLAY_ON 0xAF
@@ -84,23 +313,104 @@
 #define OLED_FLIP_H 0xA1
 
 #define OLED_CONTRAST 0x81
+#define OLED_START_LINE 0x40 // | номер строки ОЗУ, которая показывается верхней
 #define OLED_SETCOMPINS 0xDA
 #define OLED_SETVCOMDETECT 0xDB
 #define OLED_CLOCKDIV 0xD5
 #define OLED_SETMULTIPLEX 0xA8
 #define OLED_COLUMNADDR 0x21
 #define OLED_PAGEADDR 0x22
+#define OLED_PAGE_START 0xB0  // | страница - для страничной адресации
+#define OLED_COLUMN_LOW 0x00  // | младшие 4 бита столбика
+#define OLED_COLUMN_HIGH 0x10 // | старшие 4 бита столбика
+#define OLED_DCDC 0xAD        // встроенный DC/DC у SH1106
 #define OLED_CHARGEPUMP 0x8D
 
 #define OLED_NORMALDISPLAY 0xA6
 #define OLED_INVERTDISPLAY 0xA7
 
+#define OLED_SCROLL_RIGHT 0x26
+#define OLED_SCROLL_LEFT 0x27
+#define OLED_SCROLL_VRIGHT 0x29 // вертикально и вправо
+#define OLED_SCROLL_VLEFT 0x2A  // вертикально и влево
+#define OLED_SCROLL_STOP 0x2E
+#define OLED_SCROLL_START 0x2F
+#define OLED_SCROLL_AREA 0xA3
+
+// интервал между шагами прокрутки в кадрах (код для scrollH()/scrollDiag())
+#define OLED_SCROLL_2 0x07
+#define OLED_SCROLL_3 0x04
+#define OLED_SCROLL_4 0x05
+#define OLED_SCROLL_5 0x00
+#define OLED_SCROLL_25 0x06
+#define OLED_SCROLL_64 0x01
+#define OLED_SCROLL_128 0x02
+#define OLED_SCROLL_256 0x03
+
 #define BUFSIZE_128x64 (128 * 64 / 8)
 #define BUFSIZE_128x32 (128 * 32 / 8)
 
+// автомат UTF-8 для printChar(). Класс байта - по старшей тетраде: 0 - ASCII,
+// 1 - байт продолжения, 2-4 - первый байт двух-, трех-, четырехбайтного символа
+#define OLED_UTF8_CONT 1
+#define OLED_UTF8_DONE 0x40 // символ собран
+#define OLED_UTF8_ERR 0x80  // предыдущий символ оборван или байт продолжения лишний
+inline constexpr uint8_t _oled_utf8Class[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 3, 4};
+// [сколько байт продолжения ждем][класс байта] -> флаги | сколько ждать дальше
+inline constexpr uint8_t _oled_utf8Next[4][5] = {
+    {OLED_UTF8_DONE, OLED_UTF8_ERR, 1, 2, 3},
+    {OLED_UTF8_ERR | OLED_UTF8_DONE, OLED_UTF8_DONE, OLED_UTF8_ERR | 1, OLED_UTF8_ERR | 2, OLED_UTF8_ERR | 3},
+    {OLED_UTF8_ERR | OLED_UTF8_DONE, 1, OLED_UTF8_ERR | 1, OLED_UTF8_ERR | 2, OLED_UTF8_ERR | 3},
+    {OLED_UTF8_ERR | OLED_UTF8_DONE, 2, OLED_UTF8_ERR | 1, OLED_UTF8_ERR | 2, OLED_UTF8_ERR | 3},
+};
+
+// число в символы слева направо - без буфера, sprintf() и деления (у
+// CH32V003 его нет): цифра - сколько раз вычитается степень 10. sign - '-',
+// '+' или 0, decimals - знаков после точки, не больше 9 (в uint32_t больше
+// не бывает, большее значение считается за 9), width - ширина с выравниванием
+// вправо: pad слева, а '0' - после знака. hex - 16-ричное (decimals не
+// действует). put(c) получает символы, возвращается их число без учета width
+#define OLED_DECIMALS_MAX 9
+inline constexpr uint32_t _oled_pow10[10] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000};
+
+template <typename PUT>
+uint8_t oledFormat(PUT put, uint32_t value, char sign, uint8_t decimals = 0, uint8_t width = 0, char pad = ' ', bool hex = false) {
+  if (hex || decimals > OLED_DECIMALS_MAX)
+    decimals = hex ? 0 : OLED_DECIMALS_MAX;
+  uint8_t digits = 1;
+  if (hex)
+    while (digits < 8 && value >> (digits * 4))
+      digits++;
+  else
+    while (digits < 10 && value >= _oled_pow10[digits])
+      digits++;
+  if (digits <= decimals)
+    digits = decimals + 1; // 0.05
+  uint8_t len = digits + (sign != 0) + (decimals != 0);
+  if (sign && pad == '0')
+    put(sign);
+  for (uint8_t i = len; i < width; i++)
+    put(pad);
+  if (sign && pad != '0')
+    put(sign);
+  while (digits--) {
+    uint8_t d = 0;
+    if (hex)
+      d = (value >> (digits * 4)) & 0x0F;
+    else
+      for (; value >= _oled_pow10[digits]; d++)
+        value -= _oled_pow10[digits];
+    put(d < 10 ? '0' + d : 'A' - 10 + d);
+    if (digits == decimals && decimals)
+      put('.');
+  }
+  return len;
+}
+
 // список инициализации
 static const uint8_t _oled_init[] = {
     OLED_DISPLAY_OFF, // 0xAE - Выключение дисплея
+    OLED_SCROLL_STOP, // 0x2E - Остановить прокрутку (после перезапуска МК без сброса дисплея)
     OLED_CLOCKDIV,    // 0xD5 - Настройка делителя частоты
     0x80,             // Значение: 1000 0000b
                       // Бит 7-4: Fosc частота (0-15)
@@ -118,8 +428,7 @@ static const uint8_t _oled_init[] = {
     // Смещение дисплея
     // 0xD3, // Set display offset
     // 0x00, // No offset
-    // Начальная линия
-    // 0x40,                 // Set start line to 0
+    OLED_START_LINE, // 0x40 - Начальная линия 0 (консоль могла ее сдвинуть)
 
     OLED_ADDRESSING_MODE, // 0x20 - Режим адресации памяти
                           // 0x00 = Horizontal addressing mode
@@ -153,21 +462,291 @@ static const uint8_t _oled_init[] = {
     OLED_DISPLAY_ON,    // 0xAF - Включение дисплея
 };
 
+// то же для SH1106: адресация только страничная, вместо charge pump - DC/DC,
+// прокрутки нет
+static const uint8_t _sh1106_init[] = {
+    OLED_DISPLAY_OFF,   // 0xAE - Выключение дисплея
+    OLED_CLOCKDIV,      // 0xD5 - Настройка делителя частоты
+    0x80,               //
+    OLED_DCDC,          // 0xAD - Встроенный DC/DC
+    0x8B,               // 0x8B = включить
+    OLED_START_LINE,    // 0x40 - Начальная линия 0
+    OLED_NORMAL_H,      // 0xA0 - Ориентация по горизонтали
+    OLED_NORMAL_V,      // 0xC0 - Ориентация по вертикали
+    OLED_CONTRAST,      // 0x81 - Установка контрастности
+    0x7F,               //
+    OLED_SETVCOMDETECT, // 0xDB - Настройка уровня VCOM
+    0x40,               //
+    OLED_NORMALDISPLAY, // 0xA6 - Нормальный режим отображения
+    OLED_DISPLAY_ON,    // 0xAF - Включение дисплея
+};
+
+// растянуть младшие n бит bits в scale раз: каждый бит повторяется scale раз
+constexpr uint32_t oledStretchBits(uint8_t bits, uint8_t n, uint8_t scale) {
+  uint32_t r = 0;
+  for (uint8_t i = 0; i < n; i++)
+    if ((bits >> i) & 1)
+      r |= ((1UL << scale) - 1) << (i * scale);
+  return r;
+}
+
+// таблица растяжки всех значений из BITS бит в SCALE раз, считается при компиляции
+template <typename T, uint8_t BITS, uint8_t SCALE>
+struct OledStretchTable {
+  T v[1 << BITS];
+  constexpr OledStretchTable() : v() {
+    for (uint16_t i = 0; i < (1 << BITS); i++)
+      v[i] = oledStretchBits(i, BITS, SCALE);
+  }
+};
+
+// окно контроллера и указатель в нем при вертикальной адресации
+struct OledWindow {
+  uint8_t x0 = 0, x1 = 0, y0 = 0, y1 = 0; // столбики и страницы окна
+  uint8_t x = 0, y = 0;                   // куда ляжет следующий байт
+
+  // задать окно, указатель - в начало
+  void set(uint8_t nx0, uint8_t ny0, uint8_t nx1, uint8_t ny1) {
+    x0 = x = nx0;
+    x1 = nx1;
+    y0 = y = ny0;
+    y1 = ny1;
+  }
+
+  // сдвинуть указатель после записи байта: вниз по страницам, затем вправо
+  void next() {
+    if (++y > y1) {
+      y = y0;
+      if (++x > x1)
+        x = x0;
+    }
+  }
+};
+
+// флаги состояния контроллера в OledMini::_hwFlags
+#define OLED_HW_POWER 0x01
+#define OLED_HW_FLIP_H 0x02
+#define OLED_HW_FLIP_V 0x04
+#define OLED_HW_INVERT 0x08
+#define OLED_HW_SCROLL 0x10  // идет аппаратная прокрутка
+#define OLED_HW_UNKNOWN 0x80 // окно и указатель контроллера неизвестны
+
+// строка, закодированная при компиляции (см. OLED_LABEL): по 6 столбиков
+// на букву, как для drawBytes(). RUS - закодирована с кириллицей
+template <size_t N, bool RUS>
+struct OledLabel {
+  uint8_t data[N];
+};
+
+// ===== свои шрифты (setFont()) =====
+// Шрифт делает extras/tools/oledfont.py из BDF или TTF: буквы разной ширины,
+// высота любая. Буква - widths[i] столбиков по pages байт, в столбике
+// страницы сверху вниз (младший бит - верхний пиксель), начало - offsets[i]
+// в data. Коды Unicode раскладываются на буквы диапазонами ranges
+
+// коды first..first + count - 1 - буквы glyph, glyph + 1, ...
+struct OledFontRange {
+  uint16_t first;
+  uint16_t count;
+  uint16_t glyph;
+};
+
+struct OledFont {
+  uint8_t height;  // высота в пикселях
+  uint8_t pages;   // байт в столбике буквы
+  uint8_t spacing; // пустых столбиков после буквы
+  uint8_t nRanges;
+  const OledFontRange *ranges;
+  const uint16_t *offsets;
+  const uint8_t *widths;
+  const uint8_t *data;
+
+  // номер буквы для кода Unicode, -1 - в шрифте ее нет
+  int glyph(uint32_t code) const {
+    for (uint8_t i = 0; i < nRanges; i++)
+      if (code - ranges[i].first < ranges[i].count)
+        return ranges[i].glyph + (code - ranges[i].first);
+    return -1;
+  }
+};
+
+// ===== источники байтов для drawBitmap() =====
+// drawBitmap() берет байты столбиками: в каждом столбике страницы сверху вниз,
+// столбики слева направо (как их принимает контроллер при вертикальной
+// адресации). read() зовется для каждого байта строго в этом порядке, skip() -
+// для столбиков за краем экрана. hole - байт прозрачный, на дисплей не идет.
+
+// несжатый битмап: страница за страницей, в каждой width байт
+struct OledBitmapRaw {
+  const uint8_t *frame;
+  int width;
+  static constexpr bool hole = false;
+
+  uint8_t read(int col, int row) { return frame[row * width + col]; }
+  void skip(int) {}
+};
+
+// сжатый битмап OledPack (делает extras/tools/oledpack.py). Два байта
+// заголовка - ширина и высота в пикселях, дальше куски в порядке столбиков:
+//   0x00-0x7F - n + 1 байт как есть
+//   0x80-0xBF - следующий байт повторить (n & 0x3F) + 3 раз
+//   0xC0-0xFF - (n & 0x3F) + 1 прозрачных байт: дисплей под ними не трогаем
+// Распаковка идет на лету, по байту, без буфера в ОЗУ
+#define OLED_PACK_REPEAT 0x80
+#define OLED_PACK_HOLE 0xC0
+
+struct OledUnpack {
+  const uint8_t *p;
+  uint8_t left = 0, code = 0, value = 0;
+  bool hole = false;
+
+  uint8_t read(int, int) {
+    if (!left) { // начинаем новый кусок
+      code = *p++;
+      if (code < OLED_PACK_REPEAT) {
+        left = code + 1;
+      } else {
+        left = (code & 0x3F) + (code < OLED_PACK_HOLE ? 3 : 1);
+        value = code < OLED_PACK_HOLE ? *p++ : 0;
+      }
+    }
+    left--;
+    hole = code >= OLED_PACK_HOLE;
+    return code < OLED_PACK_REPEAT ? *p++ : value;
+  }
+  void skip(int rows) {
+    while (rows--)
+      read(0, 0);
+  }
+};
+
+#ifdef OLED_ASYNC
+//==============================================================================
+// Общая шина для нескольких дисплеев с OLED_ASYNC. Каждый дисплей копит
+// транзакции в своей очереди, а OledBus::poll() отправляет их по очереди
+// всех дисплеев (deficit round robin): за один заход дисплей получает
+// slice * priority байт шины, и длинный fill() на одном экране не задерживает
+// остальные больше чем на свой кусок.
+//   OledBus bus;
+//   bus.add(oled1);          // приоритет 1, без мультиплексора
+//   bus.add(oled2, 2, 1);    // вдвое больше шины, канал 1 мультиплексора
+//   bus.onSelect(muxSelect); // переключение канала перед отправкой
+// После add() poll() и wait() дисплея работают через шину, poll() шины можно
+// звать из прерывания таймера.
+//------------------------------------------------------------------------------
+class OledBus {
+  public:
+  // подключить дисплей. priority - доля шины (1 и больше), channel - канал
+  // мультиплексора, который передается в onSelect()
+  template <typename OLED>
+  bool add(OLED &oled, uint8_t priority = 1, uint8_t channel = 0) {
+    if (_count >= OLED_BUS_PANELS)
+      return false;
+    Panel &p = _panels[_count++];
+    p.oled = &oled;
+    p.nextSize = [](void *o) { return ((OLED *)o)->nextSize(); };
+    p.send = [](void *o) { ((OLED *)o)->sendNext(); };
+    p.priority = priority ? priority : 1;
+    p.channel = channel;
+    p.deficit = 0;
+    oled.setBus(this);
+    return true;
+  }
+
+  // байт шины на дисплей за заход с приоритетом 1. Меньше одной транзакции
+  // не бывает, иначе дисплей не сдвинется с места
+  void setSlice(uint16_t bytes) { _slice = bytes > WIRE_TX_BUFFER_LENGTH + 1 ? bytes : WIRE_TX_BUFFER_LENGTH + 1; }
+
+  // функция переключения канала мультиплексора (например, запись в TCA9548A)
+  void onSelect(void (*callback)(uint8_t channel)) {
+    _onSelect = callback;
+    _channel = -1; // текущий канал неизвестен
+  }
+
+  // отправить одну транзакцию очередного дисплея. false - отправлять нечего
+  bool poll() {
+    // флаг до проверки, как в OledMini::sendNext(): прерывание между
+    // проверкой и флагом отправило бы ту же транзакцию второй раз
+    if (_polling)
+      return false;
+    _polling = true;
+    if (!_count) {
+      _polling = false;
+      return false;
+    }
+    bool sent = false;
+    for (uint8_t i = 0; i <= _count; i++) {
+      Panel &p = _panels[_cur];
+      uint8_t size = p.nextSize(p.oled);
+      if (size && size <= p.deficit) { // кусок дисплея еще не исчерпан
+        if (_onSelect && _channel != p.channel) {
+          _onSelect(p.channel);
+          _channel = p.channel;
+        }
+        p.send(p.oled);
+        p.deficit -= size;
+        sent = true;
+        break;
+      }
+      if (!size)
+        p.deficit = 0; // пустой дисплей не копит право на шину
+      if (++_cur >= _count)
+        _cur = 0;
+      _panels[_cur].deficit += (uint32_t)_slice * _panels[_cur].priority;
+    }
+    _polling = false;
+    return sent;
+  }
+
+  // дождаться отправки очередей всех дисплеев
+  void wait() {
+    while (poll())
+      ;
+  }
+
+  private:
+  struct Panel {
+    void *oled;
+    uint8_t (*nextSize)(void *);
+    void (*send)(void *);
+    uint8_t priority;
+    uint8_t channel;
+    uint32_t deficit; // сколько байт дисплей еще может отправить в этом заходе (до 65535 * 255 + транзакция)
+  };
+
+  Panel _panels[OLED_BUS_PANELS];
+  uint8_t _count = 0;
+  uint8_t _cur = 0;
+  uint16_t _slice = 64;
+  int16_t _channel = -1;
+  void (*_onSelect)(uint8_t) = nullptr;
+  volatile bool _polling = false;
+};
+#endif
+
 // ========================== КЛАСС КЛАСС КЛАСС =============================
-template <int _TYPE>
+template <typename _TYPE, typename _FEAT = OledFeatures<>>
 class OledMini {
+#ifndef OLED_BUFFERED
+  static_assert(!_TYPE::pageMode, "SH1106 умеет только страничную адресацию - нужен OLED_USE_BUFFER или OLED_PAGE_BUFFER");
+#endif
+
   public:
   // ========================== КОНСТРУКТОР =============================
   OledMini(uint8_t address = 0x3C) : _address(address) {}
 
+  // вся строка уходит одним потоком данных в окно курсора: передача
+  // закрывается только при смене окна (перевод строки) и переполнении буфера Wire
   size_t write(const uint8_t *buffer, size_t size) {
+    OLED_STAT(OLED_STAT_PRINT);
     size_t n = 0;
     while (size--) {
-      if (write(*buffer++))
+      if (printChar(*buffer++))
         n++;
       else
         break;
     }
+    endTransm();
     return n;
   }
 
@@ -181,31 +760,140 @@ class OledMini {
     return write(str);
   }
 
+  // числа без sprintf() и промежуточной строки: цифры сразу идут в поток букв.
+  // width - ширина с выравниванием вправо, pad - чем дополнять слева ('0' -
+  // нули после знака), plus - '+' у положительных
+  size_t printInt(int32_t value, uint8_t width = 0, char pad = ' ', bool plus = false) {
+    return printFixed(value, 0, width, pad, plus);
+  }
+
+  size_t printUInt(uint32_t value, uint8_t width = 0, char pad = ' ') {
+    return printNumber(value, 0, 0, width, pad, false);
+  }
+
+  // 16-ричное, цифры A-F: printHex(0x3C, 4) - "003C"
+  size_t printHex(uint32_t value, uint8_t width = 0, char pad = '0') {
+    return printNumber(value, 0, 0, width, pad, true);
+  }
+
+  // value с decimals (до OLED_DECIMALS_MAX) знаками после точки:
+  // printFixed(-5, 2) - "-0.05"
+  size_t printFixed(int32_t value, uint8_t decimals, uint8_t width = 0, char pad = ' ', bool plus = false) {
+    char sign = value < 0 ? '-' : plus ? '+' : 0;
+    return printNumber(value < 0 ? 0UL - (uint32_t)value : value, sign, decimals, width, pad, false);
+  }
+
   // ============================= СЕРВИС ===============================
   // инициализация
   void init() {
     Wire.begin();
 
     beginCommand();
-    for (uint8_t i = 0; i < sizeof(_oled_init); i++)
-      sendByte(_oled_init[i]);
+    if constexpr (_TYPE::pageMode) {
+      for (uint8_t i = 0; i < sizeof(_sh1106_init); i++)
+        sendByteRaw(_sh1106_init[i]);
+    } else {
+      for (uint8_t i = 0; i < sizeof(_oled_init); i++)
+        sendByteRaw(_oled_init[i]);
+    }
     endTransm();
 
     beginCommand();
-    sendByte(OLED_SETCOMPINS);
-    sendByte(_TYPE ? OLED_HEIGHT_64 : OLED_HEIGHT_32);
-    sendByte(OLED_SETMULTIPLEX);
-    sendByte(_TYPE ? OLED_64 : OLED_32);
+    sendByteRaw(OLED_SETCOMPINS);
+    sendByteRaw(_TYPE::compins);
+    sendByteRaw(OLED_SETMULTIPLEX);
+    sendByteRaw(_TYPE::multiplex);
     endTransm();
+    _hwFlags = OLED_HW_POWER | OLED_HW_UNKNOWN; // состояние после _oled_init[]
+    _contrast = 0x7F;
+#ifdef OLED_SHADOW
+    memset(_shadow, 0, sizeof(_shadow)); // считаем экран пустым - его очистит clear()
+#endif
 
+#ifdef OLED_USE_BUFFER
+    // содержимое GDDRAM после включения неизвестно - первый update() шлет весь буфер
+    for (uint8_t y = 0; y < _BUF_ROWS; y++) {
+      _dirtyX0[y] = 0;
+      _dirtyX1[y] = _maxX;
+    }
+#endif
     setCursorXY(0, 0);
   }
 
+  // состояние контроллера - флаги OLED_HW_*. OLED_HW_UNKNOWN - была ошибка
+  // шины (или еще ничего не рисовали после init()): следующий вывод заново
+  // задаст окно, и флаг сбросится
+  uint8_t hwState() { return _hwFlags; }
+
+  // отправить на дисплей изменившиеся с прошлого вызова участки буфера.
+  // Без OLED_USE_BUFFER ничего не делает - все и так рисуется сразу.
+  void update() {
+    OLED_STAT(OLED_STAT_UPDATE);
+#ifdef OLED_USE_BUFFER
+    _toBuf = false;
+    for (uint8_t y = 0; y < _BUF_ROWS; y++)
+      if (_dirtyX0[y] <= _dirtyX1[y]) { // есть что отправить - останавливаем прокрутку
+        scrollStop();                   // сейчас, т.к. она добавит сдвинутые страницы
+        break;
+      }
+    for (uint8_t y = 0; y < _BUF_ROWS; y++) {
+      if (_dirtyX0[y] > _dirtyX1[y])
+        continue; // страница не менялась
+      setWindow(_dirtyX0[y], y, _dirtyX1[y], y);
+      beginData();
+      for (int x = _dirtyX0[y]; x <= _dirtyX1[y]; x++)
+        sendByte(_buf[y * _TYPE::width + x]);
+      endTransm();
+      if (_hwFlags & OLED_HW_UNKNOWN)
+        continue; // ошибка шины - страница останется изменившейся до следующего update()
+      _dirtyX0[y] = 255;
+      _dirtyX1[y] = 0;
+    }
+    if (_FEAT::wrap && _conMoved) { // консоль сдвинулась - строки уже на месте
+      _conMoved = false;
+      sendCommand(OLED_START_LINE | (_conTop << 3));
+    }
+    _toBuf = true;
+#endif
+  }
+
+#ifdef OLED_PAGE_BUFFER
+  // постраничная отрисовка в буфер на одну страницу:
+  //   oled.firstPage();
+  //   do {
+  //     ... рисуем весь экран ...
+  //   } while (oled.nextPage());
+  // Код рисования выполняется для каждой страницы, в буфер попадает только то,
+  // что лежит на текущей странице. Вне цикла рисование идет сразу на дисплей.
+  void firstPage() {
+    _bufPage = 0;
+    memset(_buf, 0, sizeof(_buf));
+    _toBuf = true;
+  }
+
+  // отправить готовую страницу на дисплей. false - все страницы отправлены
+  bool nextPage() {
+    OLED_STAT(OLED_STAT_UPDATE);
+    _toBuf = false;
+    setWindow(0, _bufPage, _maxX, _bufPage);
+    beginData();
+    for (uint8_t x = 0; x < _TYPE::width; x++)
+      sendByte(_buf[x]);
+    endTransm();
+    if (++_bufPage > _maxRow)
+      return false;
+    memset(_buf, 0, sizeof(_buf));
+    _toBuf = true;
+    return true;
+  }
+#endif
+
   // очистить дисплей
   void clear() { fill(0); }
 
   // очистить область
   void clear(int x0, int y0, int x1, int y1) {
+    OLED_STAT(OLED_STAT_RECT);
     x1++;
     y1++;
     y0 >>= 3;
@@ -224,122 +912,329 @@ class OledMini {
   }
 
   // яркость 0-255
-  void setContrast(uint8_t value) { sendCommand(OLED_CONTRAST, value); }
+  void setContrast(uint8_t value) {
+    if (value == _contrast)
+      return; // уже установлена
+    _contrast = value;
+    sendCommand(OLED_CONTRAST, value);
+  }
 
   // вкл/выкл
-  void setPower(bool mode) { sendCommand(mode ? OLED_DISPLAY_ON : OLED_DISPLAY_OFF); }
+  void setPower(bool mode) { sendFlag(OLED_HW_POWER, mode, OLED_DISPLAY_ON, OLED_DISPLAY_OFF); }
 
   // отразить по горизонтали
-  void flipH(bool mode) { sendCommand(mode ? OLED_FLIP_H : OLED_NORMAL_H); }
+  void flipH(bool mode) { sendFlag(OLED_HW_FLIP_H, mode, OLED_FLIP_H, OLED_NORMAL_H); }
 
   // инвертировать дисплей
-  void invertDisplay(bool mode) { sendCommand(mode ? OLED_INVERTDISPLAY : OLED_NORMALDISPLAY); }
+  void invertDisplay(bool mode) { sendFlag(OLED_HW_INVERT, mode, OLED_INVERTDISPLAY, OLED_NORMALDISPLAY); }
 
   // отразить по вертикали
-  void flipV(bool mode) { sendCommand(mode ? OLED_FLIP_V : OLED_NORMAL_V); }
+  void flipV(bool mode) { sendFlag(OLED_HW_FLIP_V, mode, OLED_FLIP_V, OLED_NORMAL_V); }
+
+  // ========================= ПРОКРУТКА =========================
+  // Прокрутку делает сам контроллер, по шине во время нее ничего не идет.
+  // Писать в ОЗУ дисплея во время прокрутки нельзя: любой вывод сначала
+  // останавливает ее сам. Горизонтальная прокрутка двигает содержимое ОЗУ,
+  // после остановки страницы page0..page1 надо перерисовать: с OLED_USE_BUFFER
+  // это сделает следующий update(), с OLED_SHADOW scrollStop() сам отправит
+  // их из копии, без них - перерисовывает программа.
+
+  // прокручивать страницы page0..page1 по горизонтали: dir - OLED_SCROLL_LEFT
+  // или OLED_SCROLL_RIGHT, interval - OLED_SCROLL_2..OLED_SCROLL_256 кадров на шаг
+  void scrollH(uint8_t dir, uint8_t page0, uint8_t page1, uint8_t interval = OLED_SCROLL_5) {
+    scrollBegin(dir, page0, page1, interval);
+    sendByteRaw(0x00);
+    sendByteRaw(0xFF);
+    scrollEnd();
+  }
+
+  // прокручивать по горизонтали страницы page0..page1 и по вертикали область
+  // scrollArea() на offset строк (1-63) за шаг: dir - OLED_SCROLL_VLEFT или
+  // OLED_SCROLL_VRIGHT. Горизонтальный сдвиг выключить нельзя - для прокрутки
+  // только по вертикали берите пустые страницы page0..page1
+  void scrollDiag(uint8_t dir, uint8_t page0, uint8_t page1, uint8_t offset, uint8_t interval = OLED_SCROLL_5) {
+    scrollBegin(dir, page0, page1, interval);
+    sendByteRaw(offset & 0x3F);
+    scrollEnd();
+  }
+
+  // область вертикальной прокрутки: top верхних строк неподвижны, следующие
+  // rows строк прокручиваются. По умолчанию - весь экран
+  void scrollArea(uint8_t top, uint8_t rows) {
+    static_assert(!_TYPE::pageMode, "у SH1106 нет аппаратной прокрутки");
+    scrollStop();
+    beginCommand();
+    sendByteRaw(OLED_SCROLL_AREA);
+    sendByteRaw(top);
+    sendByteRaw(rows);
+    endTransm();
+  }
+
+  // остановить прокрутку
+  void scrollStop() {
+    if (!(_hwFlags & OLED_HW_SCROLL))
+      return;
+    _hwFlags &= ~OLED_HW_SCROLL;
+    sendCommand(OLED_SCROLL_STOP);
+#ifdef OLED_USE_BUFFER
+    for (uint8_t y = _scrollPage0; y <= _scrollPage1 && y < _BUF_ROWS; y++) {
+      _dirtyX0[y] = 0; // в ОЗУ дисплея страницы сдвинуты - отправим их заново
+      _dirtyX1[y] = _maxX;
+    }
+#elif defined(OLED_SHADOW)
+    shadowRestore();
+#endif
+  }
 
   // ============================= ПЕЧАТЬ ==================================
-  virtual size_t write(uint8_t data) {
-
-#ifndef OLED_1306_MINI
-    // переносы и пределы
-    bool newPos = false;
-    if (data == '\r') {
-      _x = 0;
-      newPos = true;
-      data = 0;
-    } // получен возврат каретки
-    if (data == '\n') {
-      _y += _scaleY;
-      newPos = true;
-      data = 0;
-      _getn = 1;
-    } // получен перевод строки
-    if (_println && (_x + 6 * _scaleX) >= _maxX) {
-      _x = 0;
-      _y += _scaleY;
-      newPos = true;
-    } // строка переполненена, перевод и возврат
-    if (newPos)
-      setCursorXY(_x, _y); // переставляем курсор
-    if (_y + _scaleY > _maxY + 1)
-      data = 0; // дисплей переполнен
-    if (_getn && _println && data == ' ' && _x == 0) {
-      _getn = 0;
-      data = 0;
-    } // убираем первый пробел в строке
-#endif
-    // фикс русских букв и некоторых символов
-    if (data > 127) {
-      uint8_t thisData = data;
-      // data = 0 - флаг на пропуск
-      if (data > 191)
-        data = 0;
-      else if (_lastChar == 209 && data == 145)
-        data = 192; // ё кастомная
-      else if (_lastChar == 208 && data == 129)
-        data = 149; // Е вместо Ё
-      else if (_lastChar == 226 && data == 128)
-        data = 0; // тире вместо длинного тире (начало)
-      else if (_lastChar == 128 && data == 148)
-        data = 45; // тире вместо длинного тире
-      _lastChar = thisData;
-    }
-    if (data == 0)
-      return 1;
+  size_t write(uint8_t data) {
+    OLED_STAT(OLED_STAT_PRINT);
+    size_t n = printChar(data);
+    endTransm();
+    return n;
+  }
+
+  // вывести байт строки. UTF-8 собирается автоматом _oled_utf8Next, готовый
+  // символ выводит printCode(), вместо оборванного - OLED_FALLBACK.
+  // Передачу данных открывает при необходимости и оставляет открытой для
+  // следующего символа - закрывает вызывающий
+  size_t printChar(uint8_t data) {
+    if constexpr (_FEAT::text == OLED_TEXT_NONE)
+      return 0; // текст выключен
+
+    uint8_t type = _oled_utf8Class[data >> 4];
+    uint8_t next = _oled_utf8Next[_utfState][type];
+    _utf = type == OLED_UTF8_CONT ? (_utf << 6) | (data & 0x3F) : data & (0xFF >> (type + 1));
+    _utfState = next & 3;
+    if (next & OLED_UTF8_ERR)
+      printCode(0xFFFD); // оборванный символ
+    if (next & OLED_UTF8_DONE)
+      printCode(_utf);
+    return 1;
+  }
+
+  // число из oledFormat() символами прямо в printCode(), как строку
+  size_t printNumber(uint32_t value, char sign, uint8_t decimals, uint8_t width, char pad, bool hex) {
+    OLED_STAT(OLED_STAT_PRINT);
+    if constexpr (_FEAT::text == OLED_TEXT_NONE)
+      return 0; // текст выключен
+    uint8_t len = oledFormat([this](char c) { printCode(c); }, value, sign, decimals, width, pad, hex);
+    endTransm();
+    return len < width ? width : len;
+  }
+
+  // вывести символ Unicode: переносы строк, затем буква своего шрифта или
+  // встроенного. Управляющие символы не печатаются
+  void printCode(uint32_t code) {
+    if constexpr (_FEAT::wrap) {
+      // переносы и пределы
+      bool newPos = false;
+      if (code == '\r') {
+        _x = 0;
+        newPos = true;
+        code = 0;
+      } // получен возврат каретки
+      if (code == '\n') {
+        if (_console)
+          consoleLine();
+        else
+          _y += _scaleY;
+        newPos = true;
+        code = 0;
+        _getn = 1;
+      } // получен перевод строки
+      if (_println && (_x + charWidth(code)) >= _maxX) {
+        _x = 0;
+        if (_console)
+          consoleLine();
+        else
+          _y += _scaleY;
+        newPos = true;
+      } // строка переполненена, перевод и возврат
+      if (newPos)
+        setCursorXY(_x, _y); // переставляем курсор
+      if (_y + _scaleY > _maxY + 1)
+        code = 0; // дисплей переполнен
+      if (_getn && _println && code == ' ' && _x == 0) {
+        _getn = 0;
+        code = 0;
+      } // убираем первый пробел в строке
+    }
+    if (code < ' ')
+      return;
+    if (_font) {
+      printGlyph(code);
+      return;
+    }
+    int glyph = glyphIndex(code);
+    if (glyph < 0)
+      return; // нет ни буквы, ни OLED_FALLBACK
     // если тут не вылетели - печатаем символ
 
     int newX = _x + _scaleX * 6;
     if (newX < 0 || _x > _maxX)
       _x = newX; // пропускаем вывод "за экраном"
     else {
-      beginData();
-      for (uint8_t col = 0; col < 6; col++) { // 6 стобиков буквы
-        uint8_t bits = getFont(data, col);    // получаем байт
-        if (_invState)
-          bits = ~bits;                                     // инверсия
-        if (_scaleX == 1) {                                 // если масштаб 1
-          if (_x >= 0 && _x <= _maxX) {                     // внутри дисплея
-            if (_shift == 0) {                              // если вывод без сдвига на строку
-              writeData(bits, 0, 0, _mode);                 // выводим
-            } else {                                        // со сдвигом
-              writeData(bits << _shift, 0, 0, _mode);       // верхняя часть
-              writeData(bits >> (8 - _shift), 1, 0, _mode); // нижняя часть
+      if (!_busOpen)
+        beginData();
+      for (uint8_t col = 0; col < 6; col++) // 6 стобиков буквы
+        printColumn(getFont(glyph, col));
+    }
+  }
+
+  // вывести столбик буквы bits в курсор с учетом инверсии, масштаба и сдвига
+  // по строке. Передача данных уже должна быть открыта
+  void printColumn(uint8_t bits) {
+    if (_invState)
+      bits = ~bits;                                     // инверсия
+    if (_scaleX == 1) {                                 // если масштаб 1
+      if (_x >= 0 && _x <= _maxX) {                     // внутри дисплея
+        if (_shift == 0) {                              // если вывод без сдвига на строку
+          writeData(bits, 0, 0, _mode);                 // выводим
+        } else {                                        // со сдвигом
+          writeData(bits << _shift, 0, 0, _mode);       // верхняя часть
+          writeData(bits >> (8 - _shift), 1, 0, _mode); // нижняя часть
+        }
+      }
+    } else {                                     // масштаб 2, 3 или 4 - растягиваем шрифт
+      uint32_t newData = stretch(bits, _scaleX); // буфер
+
+      for (uint8_t i = 0; i < _scaleX; i++) { // выводим. По Х
+        uint8_t prevData = 0;
+        if (_x + i >= 0 && _x + i <= _maxX)                                          // внутри дисплея
+          for (uint8_t j = 0; j < _scaleX; j++) {                                    // выводим. По Y
+            uint8_t data = newData >> (j * 8);                                       // получаем кусок буфера
+            if (_shift == 0) {                                                       // если вывод без сдвига на строку
+              writeData(data, j, i, _mode);                                          // выводим
+            } else {                                                                 // со сдвигом
+              writeData((prevData >> (8 - _shift)) | (data << _shift), j, i, _mode); // склеиваем и выводим
+              prevData = data;                                                       // запоминаем предыдущий
             }
           }
-        } else {                // масштаб 2, 3 или 4 - растягиваем шрифт
-          uint32_t newData = 0; // буфер
-          for (uint8_t i = 0, count = 0; i < 8; i++)
-            for (uint8_t j = 0; j < _scaleX; j++, count++)
-              bitSet(newData, count, bitGet(bits, i)); // пакуем растянутый шрифт
-
-          for (uint8_t i = 0; i < _scaleX; i++) { // выводим. По Х
-            uint8_t prevData = 0;
-            if (_x + i >= 0 && _x + i <= _maxX)                                          // внутри дисплея
-              for (uint8_t j = 0; j < _scaleX; j++) {                                    // выводим. По Y
-                uint8_t data = newData >> (j * 8);                                       // получаем кусок буфера
-                if (_shift == 0) {                                                       // если вывод без сдвига на строку
-                  writeData(data, j, i, _mode);                                          // выводим
-                } else {                                                                 // со сдвигом
-                  writeData((prevData >> (8 - _shift)) | (data << _shift), j, i, _mode); // склеиваем и выводим
-                  prevData = data;                                                       // запоминаем предыдущий
-                }
-              }
-            if (_shift != 0)
-              writeData(prevData >> (8 - _shift), _scaleX, i, _mode); // выводим нижний кусочек, если со сдвигом
-          }
-        }
-        _x += _scaleX; // двигаемся на ширину пикселя (1-4)
+        if (_shift != 0)
+          writeData(prevData >> (8 - _shift), _scaleX, i, _mode); // выводим нижний кусочек, если со сдвигом
       }
-      endTransm();
     }
-    return 1;
+    _x += _scaleX; // двигаемся на ширину пикселя (1-4)
+  }
+
+  // печатать своим шрифтом (extras/tools/oledfont.py), nullptr - встроенным
+  // 5x8. Масштаба у своего шрифта нет: setScale() действует только на
+  // встроенный, высота строки - высота шрифта, округленная до страницы
+  void setFont(const OledFont *font) {
+    _font = font;
+    if (font) {
+      _scaleX = 1;
+      _scaleY = font->pages << 3;
+      setCursorXY(_x, _y);
+    } else {
+      setScale(1);
+    }
+  }
+
+  // ширина символа в пикселях вместе с промежутком после него
+  uint8_t charWidth(uint32_t code) {
+    if (!_font)
+      return 6 * _scaleX;
+    int glyph = fontGlyph(code);
+    return glyph < 0 ? 0 : _font->widths[glyph] + _font->spacing;
+  }
+
+  // буква своего шрифта для кода, если ее нет - OLED_FALLBACK, -1 - нет и ее
+  int fontGlyph(uint32_t code) {
+    int glyph = _font->glyph(code);
+    return glyph < 0 ? _font->glyph(OLED_FALLBACK) : glyph;
+  }
+
+  // вывести букву своего шрифта тем же потоком в окно курсора, что и
+  // встроенный шрифт. Буквы нет в шрифте - выводится OLED_FALLBACK
+  void printGlyph(uint32_t code) {
+    int glyph = fontGlyph(code);
+    if (glyph < 0)
+      return;
+    uint8_t width = _font->widths[glyph];
+    int newX = _x + width + _font->spacing;
+    if (newX < 0 || _x > _maxX) {
+      _x = newX; // пропускаем вывод "за экраном"
+      return;
+    }
+    if (!_busOpen)
+      beginData();
+    const uint8_t *bits = _font->data + _font->offsets[glyph];
+    for (uint8_t i = 0; i < width; i++, bits += _font->pages)
+      printFontColumn(bits);
+    for (uint8_t i = 0; i < _font->spacing; i++)
+      printFontColumn(nullptr); // промежуток
+  }
+
+  // вывести столбик буквы своего шрифта (nullptr - пустой) со сдвигом по
+  // строке и инверсией. Страницы за краем экрана пропускаются
+  void printFontColumn(const uint8_t *bits) {
+    if (_x >= 0 && _x <= _maxX) {
+      uint8_t pages = _font->pages, prevData = 0;
+      int row = _y >> 3;
+      for (uint8_t j = 0; j < pages; j++, row++) {
+        uint8_t data = bits ? bits[j] : 0;
+        if (_invState)
+          data = ~data;
+        if (_inRange(row, 0, _maxRow))
+          writeData((prevData >> (8 - _shift)) | (data << _shift), j, 0, _mode); // без сдвига prevData не попадает
+        prevData = data;
+      }
+      if (_shift != 0 && _inRange(row, 0, _maxRow))
+        writeData(prevData >> (8 - _shift), pages, 0, _mode); // нижний кусочек
+    }
+    _x++;
+  }
+
+  // вывести строку, закодированную при компиляции через OLED_LABEL(). Масштаб,
+  // инверсия и режим наложения - как у print(), переносы строк не действуют
+  template <size_t N, bool RUS>
+  size_t print(const OledLabel<N, RUS> &label) {
+    static_assert(_FEAT::text == OLED_TEXT_NONE || RUS == (_FEAT::text == OLED_TEXT_RUS),
+                  "надпись закодирована для другого набора букв - OLED_LABEL_TEXT()");
+    OLED_STAT(OLED_STAT_PRINT);
+    for (size_t i = 0; i < N; i += 6) {
+      int newX = _x + _scaleX * 6;
+      if (newX < 0 || _x > _maxX) {
+        _x = newX; // пропускаем вывод "за экраном"
+        continue;
+      }
+      if (!_busOpen)
+        beginData();
+      for (uint8_t col = 0; col < 6; col++)
+        printColumn(label.data[i + col]);
+    }
+    endTransm();
+    return N / 6;
   }
 
-#ifndef OLED_1306_MINI
   // автоматически переносить текст
-  void autoPrintln(bool mode) { _println = mode; }
-#endif
+  void autoPrintln(bool mode) {
+    static_assert(_FEAT::wrap, "переносы строк выключены в OledFeatures");
+    _println = mode;
+  }
+
+  // консоль для лога: экран очищается, печать идет с верхней строки, '\n'
+  // переводит строку с возвратом каретки. Когда строки кончаются, весь текст
+  // уезжает вверх: очищается одна строка и сдвигается начальная строка
+  // дисплея, по шине ~130 байт вместо перерисовки экрана. Высота строки -
+  // по масштабу на момент вызова: 1, 2 или 4 страницы (масштаб 3 - тоже 4),
+  // масштаб меняйте до console(true). Только для высоты 64: начальная строка
+  // ходит по всем 64 строкам ОЗУ. false - обычный вывод, экран сдвигается
+  // обратно и его надо перерисовать
+  void console(bool mode) {
+    static_assert(_FEAT::wrap, "переносы строк выключены в OledFeatures");
+    static_assert(_TYPE::height == 64, "консоль только для дисплеев высотой 64");
+    _console = mode;
+    _conTop = 0;
+    _conStep = _scaleX == 3 ? 4 : _scaleX;
+    consoleShow();
+    if (mode) {
+      clear();
+      home();
+    }
+  }
 
   // отправить курсор в 0,0
   void home() { setCursorXY(0, 0); }
@@ -354,8 +1249,10 @@ class OledMini {
     setWindowShift(x, y, _maxX, _scaleY);
   }
 
-  // масштаб шрифта (1-4)
+  // масштаб шрифта (1-4). Со своим шрифтом (setFont()) не действует
   void setScale(uint8_t scale) {
+    if (_font)
+      return;
     scale = constrain(scale, 1, 4); // защита от нечитающих доку
     _scaleX = scale;
     _scaleY = scale * 8;
@@ -365,6 +1262,9 @@ class OledMini {
   // инвертировать текст (0-1)
   void invertText(bool inv) { _invState = inv; }
 
+  // наложение текста: BUF_REPLACE (по умолчанию) - заменить фон, BUF_ADD - дорисовать
+  // поверх фона, BUF_SUBTRACT - стереть точки букв. Без буфера ADD и SUBTRACT
+  // учитывают фон только на страницах из OLED_SHADOW
   void textMode(uint8_t mode) { _mode = mode; }
 
   // возвращает true, если дисплей "кончился" - при побуквенном выводе
@@ -379,12 +1279,13 @@ class OledMini {
     _y = 0;
     setWindow(x, y >> 3, _maxX, _maxRow);
     beginData();
-    sendByte(!!fill << (y & 0b111)); // задвигаем 1 на высоту y
+    writeData(1 << (y & 0b111), 0, 0, fill ? BUF_ADD : BUF_CLEAR); // задвигаем 1 на высоту y
     endTransm();
   }
 
   // линия
   void line(int x0, int y0, int x1, int y1, uint8_t fill = 1) {
+    OLED_STAT(OLED_STAT_LINE);
     _x = 0;
     _y = 0;
     if (x0 == x1)
@@ -392,24 +1293,49 @@ class OledMini {
     else if (y0 == y1)
       fastLineH(y0, x0, x1, fill);
     else {
+      // Брезенхем. Пиксели линии в одном байте столбика собираем в bits, а байты
+      // соседних столбиков одной страницы - в run[], и отправляем одним окном.
       int sx, sy, e2, err;
       int dx = abs(x1 - x0);
       int dy = abs(y1 - y0);
       sx = (x0 < x1) ? 1 : -1;
       sy = (y0 < y1) ? 1 : -1;
       err = dx - dy;
+      uint8_t mode = fill ? BUF_ADD : BUF_CLEAR;
+      uint8_t run[16], n = 0, bits = 0;
+      int runX = 0, runY = 0; // столбик и страница первого байта в run[]
       for (;;) {
-        dot(x0, y0, fill);
-        if (x0 == x1 && y0 == y1)
-          return;
-        e2 = err << 1;
-        if (e2 > -dy) {
-          err -= dy;
-          x0 += sx;
+        if (_inRange(x0, 0, _maxX) && _inRange(y0, 0, _maxY))
+          bits |= 1 << (y0 & 0b111);
+        bool last = (x0 == x1 && y0 == y1);
+        int x = x0, y = y0 >> 3;
+        if (!last) {
+          e2 = err << 1;
+          if (e2 > -dy) {
+            err -= dy;
+            x0 += sx;
+          }
+          if (e2 < dx) {
+            err += dx;
+            y0 += sy;
+          }
         }
-        if (e2 < dx) {
-          err += dx;
-          y0 += sy;
+        if (bits && (last || x0 != x || (y0 >> 3) != y)) { // байт столбика готов
+          if (n && (y != runY || x != runX + n * sx || n == sizeof(run))) {
+            lineRun(run, n, runX, runY, sx, mode); // серия прервалась
+            n = 0;
+          }
+          if (n == 0) {
+            runX = x;
+            runY = y;
+          }
+          run[n++] = bits;
+          bits = 0;
+        }
+        if (last) {
+          if (n)
+            lineRun(run, n, runX, runY, sx, mode);
+          return;
         }
       }
     }
@@ -417,6 +1343,7 @@ class OledMini {
 
   // горизонтальная линия
   void fastLineH(int y, int x0, int x1, uint8_t fill = 1) {
+    OLED_STAT(OLED_STAT_LINE);
     _x = 0;
     _y = 0;
     if (x0 > x1)
@@ -435,12 +1362,13 @@ class OledMini {
     setWindow(x0, y, x1, y);
     beginData();
     for (int x = x0; x < x1; x++)
-      writeData(data, y, x);
+      writeData(data, y, x, fill ? BUF_ADD : BUF_CLEAR);
     endTransm();
   }
 
   // вертикальная линия
   void fastLineV(int x, int y0, int y1, uint8_t fill = 1) {
+    OLED_STAT(OLED_STAT_LINE);
     _x = 0;
     _y = 0;
     if (y0 > y1)
@@ -452,8 +1380,8 @@ class OledMini {
       return;
     }
     y1++;
-    if (fill)
-      fill = 255;
+    uint8_t mode = fill ? BUF_ADD : BUF_CLEAR; // стираем вычитанием маски
+    fill = 255;
     uint8_t shift = y0 & 0b111;
     uint8_t shift2 = 8 - (y1 & 0b111);
     if (shift2 == 8)
@@ -467,22 +1395,23 @@ class OledMini {
     beginData();
     if (numBytes == 0) {
       if (_inRange(y0, 0, _maxRow))
-        writeData((fill >> (8 - height)) << shift, y0, x);
+        writeData((fill >> (8 - height)) << shift, y0, x, mode);
     } else {
       if (_inRange(y0, 0, _maxRow))
-        writeData(fill << shift, y0, x); // начальный кусок
+        writeData(fill << shift, y0, x, mode); // начальный кусок
       y0++;
       for (uint8_t i = 0; i < numBytes - 1; i++, y0++)
         if (_inRange(y0, 0, _maxRow))
-          writeData(fill, y0, x); // столбик
+          writeData(fill, y0, x, mode); // столбик
       if (_inRange(y0, 0, _maxRow))
-        writeData(fill >> shift2, y0, x); // нижний кусок
+        writeData(fill >> shift2, y0, x, mode); // нижний кусок
     }
     endTransm();
   }
 
   // прямоугольник (лев. верхн, прав. нижн)
   void rect(int x0, int y0, int x1, int y1, uint8_t fill = 1) {
+    OLED_STAT(OLED_STAT_RECT);
     _x = 0;
     _y = 0;
     if (x0 > x1)
@@ -507,12 +1436,7 @@ class OledMini {
         fastLineH(y0, x0, x1, fill);
         return;
       }
-      if (fill == OLED_CLEAR) {
-        clear(x0, y0, x1, y1);
-        return;
-      }
-
-      uint8_t thisFill = (fill == OLED_FILL ? 0 : 1);
+      uint8_t thisFill = (fill == OLED_FILL ? BUF_ADD : BUF_CLEAR); // OLED_CLEAR - вычитаем
       // рисуем в олед
       y1++;
       uint8_t shift = y0 & 0b111;
@@ -548,9 +1472,10 @@ class OledMini {
     }
   }
 
-#ifndef OLED_1306_MINI
   // прямоугольник скруглённый (лев. верхн, прав. нижн)
   void roundRect(int x0, int y0, int x1, int y1, uint8_t fill = OLED_FILL) {
+    OLED_STAT(OLED_STAT_RECT);
+    static_assert(_FEAT::shapes, "roundRect() выключен в OledFeatures");
     if (fill == OLED_STROKE) {
       fastLineV(x0, y0 + 2, y1 - 2);
       fastLineV(x1, y0 + 2, y1 - 2);
@@ -568,11 +1493,10 @@ class OledMini {
       rect(x0 + 2, y0, x1 - 2, y1, fill);
     }
   }
-#endif
 
-#ifndef OLED_1306_MINI
   // окружность (центр х, центр у, радиус, заливка)
   void circle(int x, int y, int radius, uint8_t fill = OLED_FILL) {
+    static_assert(_FEAT::shapes, "circle() выключен в OledFeatures");
     int f = 1 - radius;
     int ddF_x = 1;
     int ddF_y = -2 * radius;
@@ -612,50 +1536,30 @@ class OledMini {
       }
     }
   }
-#endif
 
   // #ifndef OLED_1306_MINI
   // вывести битмап
   void drawBitmap(int x, int y, const uint8_t *frame, int width, int height, uint8_t invert = 0, uint8_t mode = 0) {
-    _x = 0;
-    _y = 0;
-    if (invert)
-      invert = 255;
-    uint8_t left = height & 0b111;
-    if (left != 0)
-      height += (8 - left);                                          // округляем до ближайшего кратного степени 2
-    int shiftY = (y >> 3) + (height >> 3);                           // строка (row) крайнего байта битмапа
-    setWindowShift(x, y, width, height);                             // выделяем окно
-    bool bottom = (_shift != 0 && shiftY >= 0 && shiftY <= _maxRow); // рисовать ли нижний сдвинутый байт
+    OLED_STAT(OLED_STAT_BITMAP);
+    OledBitmapRaw src{frame, width};
+    drawColumns(x, y, src, width, height, invert, mode);
+  }
 
-    beginData();
-    for (int X = x, countX = 0; X < x + width; X++, countX++) { // в пикселях
-      uint8_t prevData = 0;
-      if (_inRange(X, 0, _maxX)) {                                    // мы внутри дисплея по X
-        for (int Y = y >> 3, countY = 0; Y < shiftY; Y++, countY++) { // в строках (пикс/8)
-          uint8_t data = (frame[countY * width + countX]) ^ invert;   // достаём байт
-          if (_shift == 0) {                                          // без сдвига по Y
-            if (_inRange(Y, 0, _maxRow))
-              writeData(data, Y, X, mode); // мы внутри дисплея по Y
-          } else {                         // со сдвигом по Y
-            if (_inRange(Y, 0, _maxRow))
-              writeData((prevData >> (8 - _shift)) | (data << _shift), Y, X, mode); // задвигаем
-            prevData = data;
-          }
-        }
-        if (bottom)
-          writeData(prevData >> (8 - _shift), shiftY, X, mode); // нижний байт
-      }
-    }
-    endTransm();
+  // вывести сжатый битмап OledPack (размер - в его заголовке). Прозрачные
+  // куски не передаются: окно контроллера переставляется через них
+  void drawPacked(int x, int y, const uint8_t *packed, uint8_t invert = 0, uint8_t mode = 0) {
+    OLED_STAT(OLED_STAT_BITMAP);
+    OledUnpack src{packed + 2};
+    drawColumns(x, y, src, packed[0], packed[1], invert, mode);
   }
   // #endif
 
   // залить весь дисплей указанным байтом
   void fill(uint8_t data) {
+    OLED_STAT(OLED_STAT_FILL);
     setWindow(0, 0, _maxX, _maxRow);
     beginData();
-    for (int i = 0; i < (_TYPE ? 1024 : 512); i++)
+    for (int i = 0; i < _TYPE::width * _TYPE::pages; i++)
       sendByte(data);
     endTransm();
     setCursorXY(_x, _y);
@@ -664,6 +1568,7 @@ class OledMini {
   // #ifndef OLED_1306_MINI
   // шлёт байт в "столбик" setCursor() и setCursorXY()
   void drawByte(uint8_t data) {
+    OLED_STAT(OLED_STAT_BITMAP);
     if (++_x > _maxX)
       return;
     beginData();
@@ -678,6 +1583,7 @@ class OledMini {
 
   // вывести одномерный байтовый массив (линейный битмап высотой 8)
   void drawBytes(const uint8_t *data, uint8_t size) {
+    OLED_STAT(OLED_STAT_BITMAP);
     beginData();
     for (uint8_t i = 0; i < size; i++) {
       if (++_x > _maxX)
@@ -694,9 +1600,97 @@ class OledMini {
   // #endif
 
   // ================================== СИСТЕМНОЕ ===================================
-  // отправить байт на дисплей
+  // отправить байт на дисплей (в буфер) с наложением mode: BUF_ADD, BUF_SUBTRACT, BUF_REPLACE.
+  // Фон берется из буфера или из копии OLED_SHADOW. Если страницы нет ни там,
+  // ни там, фон неизвестен и считается пустым: вычитание дает 0.
   void writeData(uint8_t data, uint8_t offsetY = 0, uint8_t offsetX = 0, int mode = 0) {
-    sendByte(data);
+#ifdef OLED_BUFFERED
+    if (_toBuf) {
+      bufWrite(data, mode);
+      return;
+    }
+#endif
+#ifdef OLED_SHADOW
+    if (uint8_t *dst = shadowAt()) { // накладываем на то, что уже на экране
+      if (mode == BUF_ADD)
+        data |= *dst;
+      else if (mode == BUF_SUBTRACT || mode == BUF_CLEAR)
+        data = *dst & ~data;
+      sendByte(data);
+      return;
+    }
+#endif
+    sendByte(mode == BUF_CLEAR ? 0 : data); // фон неизвестен: ADD и SUBTRACT заменяют байт
+  }
+
+  // вывод битмапа из источника src (OledBitmapRaw, OledUnpack) с наложением
+  // mode и сдвигом по Y. Если src отдает прозрачные байты, их не шлем, а
+  // перед следующим непрозрачным переставляем окно: с начала столбика - на
+  // остаток окна, с середины - на хвост этого столбика, а после него снова
+  // на остаток окна
+  template <typename SRC>
+  void drawColumns(int x, int y, SRC &src, int width, int height, uint8_t invert, uint8_t mode) {
+    _x = 0;
+    _y = 0;
+    if (invert)
+      invert = 255;
+    uint8_t left = height & 0b111;
+    if (left != 0)
+      height += (8 - left);                                          // округляем до ближайшего кратного степени 2
+    int shiftY = (y >> 3) + (height >> 3);                           // строка (row) крайнего байта битмапа
+    setWindowShift(x, y, width, height);                             // выделяем окно
+    bool bottom = (_shift != 0 && shiftY >= 0 && shiftY <= _maxRow); // рисовать ли нижний сдвинутый байт
+    int top = constrain(y >> 3, 0, _maxRow);                         // окно - для перестановки после дыр
+    int last = constrain((y + height - 1) >> 3, 0, _maxRow);
+    int right = constrain(x + width, 0, _maxX);
+    bool jump = false; // указатель стоит не там, где следующий байт
+    bool tail = false; // окно - хвост одного столбика
+
+    // вывести байт столбика X на странице Y, если он не прозрачный
+    auto put = [&](uint8_t data, bool hole, int Y, int X) {
+      if (hole) {
+        jump = true;
+        return;
+      }
+      if (jump) {
+        tail = Y != top;
+        setWindow(X, Y, tail ? X : right, last);
+        beginData();
+        jump = false;
+      }
+      writeData(data, Y, X, mode);
+    };
+
+    beginData();
+    for (int X = x, countX = 0; X < x + width; X++, countX++) { // в пикселях
+      if (!_inRange(X, 0, _maxX)) {                             // столбик за краем дисплея
+        src.skip(shiftY - (y >> 3));
+        continue;
+      }
+      uint8_t prevData = 0;
+      bool prevHole = true;
+      for (int Y = y >> 3, countY = 0; Y < shiftY; Y++, countY++) { // в строках (пикс/8)
+        uint8_t data = src.read(countX, countY) ^ invert;           // достаём байт
+        if (src.hole)
+          data = 0; // под прозрачным фон неизвестен, считаем пустым
+        if (_shift == 0) {             // без сдвига по Y
+          if (_inRange(Y, 0, _maxRow)) // мы внутри дисплея по Y
+            put(data, src.hole, Y, X);
+        } else { // со сдвигом по Y
+          if (_inRange(Y, 0, _maxRow))
+            put((prevData >> (8 - _shift)) | (data << _shift), src.hole && prevHole, Y, X); // задвигаем
+          prevData = data;
+          prevHole = src.hole;
+        }
+      }
+      if (bottom)
+        put(prevData >> (8 - _shift), prevHole, shiftY, X); // нижний байт
+      if (tail) { // хвост столбика кончился - дальше снова все окно
+        jump = true;
+        tail = false;
+      }
+    }
+    endTransm();
   }
 
   // окно со сдвигом. x 0-127, y 0-63 (31), ширина в пикселях, высота в пикселях
@@ -705,23 +1699,157 @@ class OledMini {
     setWindow(x0, (y0 >> 3), x0 + sizeX, (y0 + sizeY - 1) >> 3);
   }
 
+#ifdef OLED_ASYNC
+  // ========= ОЧЕРЕДЬ ТРАНЗАКЦИЙ =========
+  // С OLED_ASYNC вывод не ждет шину: транзакции складываются в кольцевую очередь
+  // (байт длины + байты транзакции), а отправляет их poll() - по одной за вызов.
+  // poll() вызывается из прерывания таймера или из главного цикла. Если очередь
+  // заполнена, рисование само вызывает poll() и ждет места.
+
+  // отправить одну транзакцию из очереди. false - отправлять нечего.
+  // Дисплей на общей шине (OledBus::add) отдает отправку шине: она выберет,
+  // чья транзакция следующая
+  bool poll() {
+    if (_bus)
+      return _bus->poll();
+    return sendNext();
+  }
+
+  // в очереди есть неотправленные транзакции
+  bool busy() { return _qTail != _qDone; }
+
+  // дождаться отправки всей очереди
+  void wait() {
+    while (busy())
+      poll();
+  }
+
+  // функция, которую poll() вызовет, когда очередь опустеет
+  void onDone(void (*callback)()) { _onDone = callback; }
+
+  // для OledBus: байт на шине у следующей транзакции (с адресом), 0 - очередь пуста
+  uint8_t nextSize() { return _qTail == _qDone ? 0 : _q[_qTail] + 1; }
+
+  // для OledBus: отправить одну транзакцию из своей очереди
+  bool sendNext() {
+    // флаг ставим до проверки очереди: прерывание, пришедшее между проверкой
+    // и флагом, могло бы забрать последнюю транзакцию, и мы отправили бы
+    // мусор за _qDone. Прерывание после флага сразу выходит
+    if (_qPolling)
+      return false; // уже отправляем (из прерывания)
+    _qPolling = true;
+    if (_qTail == _qDone) {
+      _qPolling = false;
+      return false; // очередь пуста
+    }
+    uint16_t i = _qTail;
+    uint8_t n = _q[i];
+    i = queueNext(i);
+    busBegin();
+    while (n--) {
+      busWrite(_q[i]);
+      i = queueNext(i);
+    }
+    if (busEnd()) {
+      _hwFlags |= OLED_HW_UNKNOWN; // ошибка шины - что дошло до контроллера, неизвестно
+#ifdef OLED_STATS
+      _stats.group[OLED_STAT_OTHER].errors++;
+#endif
+    }
+    _qTail = i;
+    _qPolling = false;
+    if (_qTail == _qDone && _onDone)
+      _onDone();
+    return true;
+  }
+
+  // вызывается из OledBus::add()
+  void setBus(OledBus *bus) { _bus = bus; }
+#endif
+
+#ifdef OLED_STATS
+  // ========= СТАТИСТИКА =========
+  // снимок счетчиков по группам OLED_STAT_*, например для вывода в UART:
+  //   OledStats st = oled.stats();
+  //   for (uint8_t g = 0; g < OLED_STAT_COUNT; g++)
+  //     printf("%s %lu/%lu\n", oled.statName(g), st.group[g].maxTime, st.group[g].transactions);
+  OledStats stats() { return _stats; }
+
+  // обнулить счетчики - например, в начале экрана, время которого меряем
+  void resetStats() { memset(&_stats, 0, sizeof(_stats)); }
+
+  static const char *statName(uint8_t group) { return _oled_statNames[group]; }
+#endif
+
   // ========= ЛОУ-ЛЕВЕЛ ОТПРАВКА =========
 
   //==============================================================================
   // sendBiteRaw() - отправляет байт в буфер Wire.
   // Если буфер заполнен, нужно вызвать Wire.endTransmission(), чтобы отправить
   // буфер Wire на дисплей и заново начать Wire.beginTransmission().
+  // С OLED_I2C_DIRECT буфера нет, и передача не режется (кроме OLED_ASYNC:
+  // очередь хранит транзакции не длиннее буфера Wire).
   //------------------------------------------------------------------------------
   void sendByte(uint8_t data) {
+#ifdef OLED_BUFFERED
+    if (_toBuf) {
+      bufWrite(data, BUF_REPLACE);
+      return;
+    }
+#endif
+#ifdef OLED_SHADOW
+    if (uint8_t *dst = shadowAt())
+      *dst = data;
+#endif
     sendByteRaw(data);
+    _hw.next(); // указатель контроллера сдвинулся
+#if !defined(OLED_I2C_DIRECT) || defined(OLED_ASYNC)
     _writes++;
     if (_writes >= WIRE_TX_BUFFER_LENGTH - 1) { // -1, чтобы не переполнить буфер
+#ifdef OLED_STATS
+      stat().splits++;
+#endif
       endTransm();
       beginData();
     }
+#endif
   }
   void sendByteRaw(uint8_t data) {
+#ifdef OLED_STATS
+    (_statData ? stat().dataBytes : stat().cmdBytes)++;
+#endif
+#ifdef OLED_ASYNC
+    _q[_qHead] = data;
+    _qHead = queueNext(_qHead);
+    _qCount++;
+#else
+    busWrite(data);
+#endif
+  }
+
+  // транзакция на шине: через Wire или, с OLED_I2C_DIRECT, прямо через I2C1
+  void busBegin() {
+#ifdef OLED_I2C_DIRECT
+    OledI2C::start(_address);
+#else
+    Wire.beginTransmission(_address);
+#endif
+  }
+
+  void busWrite(uint8_t data) {
+#ifdef OLED_I2C_DIRECT
+    OledI2C::write(data);
+#else
     Wire.write(data);
+#endif
+  }
+
+  uint8_t busEnd() {
+#ifdef OLED_I2C_DIRECT
+    return OledI2C::stop();
+#else
+    return Wire.endTransmission();
+#endif
   }
 
   // отправить команду
@@ -739,76 +1867,229 @@ class OledMini {
     endTransm();
   }
 
+  // отправить cmdOn/cmdOff, если флаг контроллера flag еще не в состоянии mode
+  void sendFlag(uint8_t flag, bool mode, uint8_t cmdOn, uint8_t cmdOff) {
+    if (!(_hwFlags & flag) == !mode)
+      return;
+    _hwFlags ^= flag;
+    sendCommand(mode ? cmdOn : cmdOff);
+  }
+
   // выбрать "окно" дисплея
   void setWindow(int x0, int y0, int x1, int y1) {
+#ifdef OLED_BUFFERED
+    if (_toBuf) { // окно и указатель ведем сами, как это делает контроллер
+      _bufWin.set(constrain(x0, 0, _maxX), constrain(y0, 0, _maxRow), constrain(x1, 0, _maxX), constrain(y1, 0, _maxRow));
+      return;
+    }
+#endif
+    endTransm(); // окно меняется посреди текста - закрываем начатую передачу данных
+    scrollStop(); // во время прокрутки ОЗУ дисплея не трогаем
+    x0 = constrain(x0, 0, _maxX);
+    x1 = constrain(x1, 0, _maxX);
+    y0 = constrain(y0, 0, _maxRow);
+    y1 = constrain(y1, 0, _maxRow);
+    // шлем только то, что у контроллера отличается: адрес столбиков или страниц
+    // (каждая команда заодно ставит свою половину указателя в начало окна)
+    bool unknown = _hwFlags & OLED_HW_UNKNOWN;
+    bool cols = unknown || x0 != _hw.x0 || x1 != _hw.x1 || x0 != _hw.x;
+    bool pages = unknown || y0 != _hw.y0 || y1 != _hw.y1 || y0 != _hw.y;
+    if (!cols && !pages)
+      return; // контроллер уже в этом окне
     beginCommand();
-    sendByteRaw(OLED_COLUMNADDR);
-    sendByteRaw(constrain(x0, 0, _maxX));
-    sendByteRaw(constrain(x1, 0, _maxX));
-    sendByteRaw(OLED_PAGEADDR);
-    sendByteRaw(constrain(y0, 0, _maxRow));
-    sendByteRaw(constrain(y1, 0, _maxRow));
+    if constexpr (_TYPE::pageMode) {
+      // SH1106: окно - одна страница (рисуем только через буфер), конец
+      // столбиков контроллер не знает и указатель за x1 не возвращает -
+      // столбик шлем всегда
+      if (pages)
+        sendByteRaw(OLED_PAGE_START | y0);
+      sendByteRaw(OLED_COLUMN_LOW | ((x0 + _TYPE::offset) & 0x0F));
+      sendByteRaw(OLED_COLUMN_HIGH | ((x0 + _TYPE::offset) >> 4));
+    } else {
+      if (cols) {
+        sendByteRaw(OLED_COLUMNADDR);
+        sendByteRaw(x0 + _TYPE::offset);
+        sendByteRaw(x1 + _TYPE::offset);
+      }
+      if (pages) {
+        sendByteRaw(OLED_PAGEADDR);
+        sendByteRaw(y0);
+        sendByteRaw(y1);
+      }
+    }
+    // окно запоминаем до конца транзакции: если команду не приняли,
+    // endTransm() снова поставит OLED_HW_UNKNOWN
+    _hw.set(x0, y0, x1, y1);
+    _hwFlags &= ~OLED_HW_UNKNOWN;
     endTransm();
   }
 
   void beginData() {
-    startTransm();
+#ifdef OLED_BUFFERED
+    if (_toBuf)
+      return; // рисуем в буфер, шину не трогаем
+#endif
+    scrollStop();
+    startTransm(true);
     sendByteRaw(OLED_DATA_MODE);
   }
 
   void beginCommand() {
-    startTransm();
+    startTransm(false);
     sendByteRaw(OLED_COMMAND_MODE);
   }
 
   void beginOneCommand() {
-    startTransm();
+    startTransm(false);
     sendByteRaw(OLED_ONE_COMMAND_MODE);
   }
 
   void endTransm() {
-    Wire.endTransmission();
+    if (!_busOpen)
+      return; // передачу не начинали (рисовали в буфер)
+#ifdef OLED_ASYNC
+    _q[_qStart] = _qCount; // транзакция записана - теперь ее может забрать poll()
+    _qDone = _qHead;
+#else
+    if (busEnd()) {
+      _hwFlags |= OLED_HW_UNKNOWN; // ошибка шины - что дошло до контроллера, неизвестно
+#ifdef OLED_STATS
+      stat().errors++;
+#endif
+    }
+#endif
+    _busOpen = false;
     _writes = 0;
     // Delay_Us(2);
   }
 
-  void startTransm() {
-    Wire.beginTransmission(_address);
+  // начать транзакцию: data - данных или команд (для OLED_STATS)
+  void startTransm([[maybe_unused]] bool data) {
+#ifdef OLED_STATS
+    _statData = data;
+    stat().transactions++;
+#endif
+#ifdef OLED_ASYNC
+    // ждем места под самую длинную транзакцию и байт ее длины
+    while ((uint16_t)(_qTail + OLED_QUEUE_SIZE - _qHead - 1) % OLED_QUEUE_SIZE < WIRE_TX_BUFFER_LENGTH + 1)
+      poll();
+    _qStart = _qHead;
+    _qHead = queueNext(_qHead);
+    _qCount = 0;
+#else
+    busBegin();
+#endif
+    _busOpen = true;
   }
 
-  // получить "столбик-байт" буквы
-  uint8_t getFont(uint8_t font, uint8_t row) {
-#ifndef OLED_NO_PRINT
-    if (row > 4)
-      return 0;
-    font = font - '0' + 16; // перевод код символа из таблицы ASCII
-    if (font <= 95) {
-      // return (_charMap[font][row]); // для английских букв и символов
-      return getCharMap(font, row); // для английских букв и символов(_charMap[font][row]); // для английских букв и символов
-    }
-#ifndef OLED_NO_RUS
-    if (font >= 96 && font <= 111) {
-      // return (_charMap[font + 47][row]);
-      return getCharMap(font + 47, row); // для кастомных (ё)(_charMap[font + 47][row]);
-    } else if (font <= 159) {
-      // return (_charMap[font - 17][row]);
-      return getCharMap(font - 17, row); // для кастомных (ё)(_charMap[font - 17][row]);
+  // растянуть столбик буквы для масштаба 2-4 способом из OLED_STRETCH2..4
+  static uint32_t stretch(uint8_t bits, uint8_t scale) {
+    if (scale == 2)
+      return stretchBy<2, OLED_STRETCH2>(bits);
+    if (scale == 3)
+      return stretchBy<3, OLED_STRETCH3>(bits);
+    return stretchBy<4, OLED_STRETCH4>(bits);
+  }
+
+  template <uint8_t SCALE, int METHOD>
+  static uint32_t stretchBy(uint8_t bits) {
+    if constexpr (METHOD == OLED_STRETCH_BYTE) {
+      if constexpr (SCALE == 2) {
+        static constexpr OledStretchTable<uint16_t, 8, 2> table;
+        return table.v[bits];
+      } else {
+        static constexpr OledStretchTable<uint32_t, 8, SCALE> table;
+        return table.v[bits];
+      }
+    } else if constexpr (METHOD == OLED_STRETCH_NIBBLE) {
+      static constexpr OledStretchTable<uint16_t, 4, SCALE> table;
+      return table.v[bits & 0x0F] | (uint32_t)table.v[bits >> 4] << (4 * SCALE);
+    } else if constexpr (METHOD == OLED_STRETCH_SWAR) {
+      // раздвигаем биты на SCALE позиций (половины, четверти, по одному),
+      // затем размножаем каждый бит вправо
+      uint32_t x = bits;
+      if constexpr (SCALE == 2) {
+        x = (x | x << 4) & 0x0F0F;
+        x = (x | x << 2) & 0x3333;
+        x = (x | x << 1) & 0x5555;
+        return x | x << 1;
+      } else if constexpr (SCALE == 3) {
+        x = (x | x << 8) & 0x00F00F;
+        x = (x | x << 4) & 0x0C30C3;
+        x = (x | x << 2) & 0x249249;
+        return x | x << 1 | x << 2;
+      } else {
+        x = (x | x << 12) & 0x000F000F;
+        x = (x | x << 6) & 0x03030303;
+        x = (x | x << 3) & 0x11111111;
+        return x * 0x0F;
+      }
     } else {
-      // return (_charMap[font - 1][row]); // для кастомных (ё)
-      return getCharMap(font - 1, row); // для кастомных (ё)
+      uint32_t newData = 0;
+      for (uint8_t i = 0, count = 0; i < 8; i++)
+        for (uint8_t j = 0; j < SCALE; j++, count++)
+          bitSet(newData, count, bitGet(bits, i)); // пакуем растянутый шрифт
+      return newData;
     }
-#endif // OLED_NO_RUS
-#endif // OLED_NO_PRINT
-    return 0;
+  }
+
+  // столбик row (0-5) буквы номер glyph встроенного шрифта (см. oledGlyphIndex())
+  uint8_t getFont(int glyph, uint8_t row) {
+    if (row > 4)
+      return 0; // промежуток между буквами
+#ifdef OLED_FONT_SUBSET
+    return getCharMapSubset(glyph, row); // glyph - номер в наборе OLED_FONT_SUBSET
+#else
+    if (glyph < 95)
+      return getCharMap(glyph, row); // ASCII
+    if constexpr (_FEAT::text == OLED_TEXT_RUS)
+      if (glyph < 160)
+        return getCharMapRus(glyph - 95, row); // кириллица
+    return getCharMapSym(glyph - 160, row);    // значки
+#endif
   }
 
   // ==================== ПЕРЕМЕННЫЕ И КОНСТАНТЫ ====================
   const uint8_t _address = 0x3C;
-  const uint8_t _maxRow = (_TYPE ? 8 : 4) - 1;
-  const uint8_t _maxY = (_TYPE ? 64 : 32) - 1;
-  const uint8_t _maxX = OLED_WIDTH - 1; // на случай добавления мелких дисплеев
+  static constexpr uint8_t _maxRow = _TYPE::pages - 1;
+  static constexpr uint8_t _maxY = _TYPE::height - 1;
+  static constexpr uint8_t _maxX = _TYPE::width - 1;
 
   private:
+#ifdef OLED_STATS
+  // вызов функции группы group: меряет его время, а байты и транзакции внутри
+  // считаются в эту группу. Вложенный вызов остается в группе внешнего
+  class StatScope {
+    public:
+    StatScope(OledMini &oled, uint8_t group) : _oled(oled), _nested(oled._statGroup != OLED_STAT_OTHER) {
+      if (_nested)
+        return;
+      oled._statGroup = group;
+      _start = OLED_STATS_CLOCK();
+    }
+
+    ~StatScope() {
+      if (_nested)
+        return;
+      uint32_t time = OLED_STATS_CLOCK() - _start;
+      OledStat &st = _oled.stat();
+      if (!st.calls++ || time < st.minTime)
+        st.minTime = time;
+      if (time > st.maxTime)
+        st.maxTime = time;
+      st.totalTime += time;
+      _oled._statGroup = OLED_STAT_OTHER;
+    }
+
+    private:
+    OledMini &_oled;
+    bool _nested;
+    uint32_t _start = 0;
+  };
+
+  OledStat &stat() { return _stats.group[_statGroup]; }
+#endif
+
   void _swap(int &x, int &y) {
     int z = x;
     x = y;
@@ -819,192 +2100,803 @@ class OledMini {
     return x >= mi && x <= ma;
   }
 
-  uint8_t getCharMap(uint8_t font, uint8_t row);
+  // остановить прокрутку и начать команду прокрутки: код, пустой байт,
+  // страницы и интервал
+  void scrollBegin(uint8_t dir, uint8_t page0, uint8_t page1, uint8_t interval) {
+    static_assert(!_TYPE::pageMode, "у SH1106 нет аппаратной прокрутки");
+    scrollStop(); // параметры меняются только у остановленной прокрутки
+    page0 = constrain(page0, 0, _maxRow);
+    page1 = constrain(page1, page0, _maxRow);
+    beginCommand();
+    sendByteRaw(dir);
+    sendByteRaw(0x00);
+    sendByteRaw(page0);
+    sendByteRaw(interval & 0x07);
+    sendByteRaw(page1);
+    _scrollPage0 = page0;
+    _scrollPage1 = page1;
+  }
+
+  // запустить прокрутку той же передачей
+  void scrollEnd() {
+    sendByteRaw(OLED_SCROLL_START);
+    endTransm();
+    _hwFlags |= OLED_HW_SCROLL;
+  }
+
+  // перевод строки в консоли: курсор на следующую строку кольца страниц. Если
+  // она была верхней на экране - очищаем ее и делаем верхней следующую
+  void consoleLine() {
+    uint8_t step = _conStep;
+    uint8_t page = ((_y >> 3) + step) & _maxRow;
+    _x = 0;
+    _y = page << 3;
+    if (page == _conTop) {
+      setWindow(0, page, _maxX, page + step - 1);
+      beginData();
+      for (int i = 0; i < _TYPE::width * step; i++)
+        sendByte(0);
+      endTransm();
+      _conTop = (page + step) & _maxRow;
+      consoleShow();
+    }
+  }
+
+  // показать страницу _conTop верхней. С буфером - в update(), после очищенной строки
+  void consoleShow() {
+#ifdef OLED_USE_BUFFER
+    _conMoved = true;
+#else
+    sendCommand(OLED_START_LINE | (_conTop << 3));
+#endif
+  }
+
+  // отправить серию байт линии на странице page начиная со столбика x.
+  // При sx < 0 столбики шли справа налево - шлем задом наперед,
+  // т.к. контроллер умеет только увеличивать адрес столбика.
+  void lineRun(const uint8_t *run, uint8_t n, int x, int page, int sx, uint8_t mode) {
+    if (sx < 0)
+      x -= n - 1;
+    setWindow(x, page, x + n - 1, page);
+    beginData();
+    for (uint8_t i = 0; i < n; i++)
+      writeData(run[sx > 0 ? i : n - 1 - i], 0, 0, mode);
+    endTransm();
+  }
+
+  uint8_t getCharMap(uint8_t font, uint8_t row);    // ASCII
+  uint8_t getCharMapRus(uint8_t font, uint8_t row); // кириллица
+  uint8_t getCharMapSym(uint8_t font, uint8_t row); // значки
+  uint8_t getCharMapSubset(uint8_t font, uint8_t row); // OLED_FONT_SUBSET
+  int glyphIndex(uint32_t code);                    // буква встроенного шрифта или OLED_FALLBACK
+
+#ifdef OLED_BUFFERED
+#ifdef OLED_USE_BUFFER
+  static constexpr uint8_t _BUF_ROWS = _TYPE::pages;
+#else
+  static constexpr uint8_t _BUF_ROWS = 1;
+#endif
+
+  // записать байт в буфер по указателю и сдвинуть указатель, как это делает контроллер
+  void bufWrite(uint8_t data, int mode) {
+    uint8_t row = _bufWin.y - _bufPage;
+    if (row < _BUF_ROWS) { // страница в буфере (в постраничном режиме - текущая)
+      uint8_t &dst = _buf[row * _TYPE::width + _bufWin.x];
+      if (mode == BUF_ADD)
+        data |= dst;
+      else if (mode == BUF_SUBTRACT || mode == BUF_CLEAR)
+        data = dst & ~data;
+#ifdef OLED_USE_BUFFER
+      if (dst != data) { // запоминаем изменившиеся столбцы страницы
+        if (_bufWin.x < _dirtyX0[row])
+          _dirtyX0[row] = _bufWin.x;
+        if (_bufWin.x > _dirtyX1[row])
+          _dirtyX1[row] = _bufWin.x;
+      }
+#endif
+      dst = data;
+    }
+    _bufWin.next();
+  }
+
+  uint8_t _buf[_BUF_ROWS * _TYPE::width] = {};
+#ifdef OLED_USE_BUFFER
+  uint8_t _dirtyX0[_BUF_ROWS] = {}, _dirtyX1[_BUF_ROWS] = {}; // изменившиеся столбцы по страницам
+  static constexpr uint8_t _bufPage = 0;
+  bool _toBuf = true; // false - на время update()
+#else
+  uint8_t _bufPage = 0; // текущая страница
+  bool _toBuf = false;  // true - внутри цикла firstPage()/nextPage()
+#endif
+  OledWindow _bufWin; // окно и указатель в буфере
+#endif
+#ifdef OLED_SHADOW
+  static constexpr uint8_t _SHADOW_ROWS = (OLED_SHADOW_LAST < _TYPE::pages ? OLED_SHADOW_LAST + 1 : _TYPE::pages) - OLED_SHADOW_FIRST;
+  static_assert(OLED_SHADOW_FIRST < _TYPE::pages, "OLED_SHADOW_FIRST за пределами дисплея");
+
+  // байт копии под указателем контроллера или nullptr, если страница не копируется
+  // вернуть в ОЗУ дисплея сдвинутые прокруткой страницы из копии. Вызывается
+  // из beginData(), когда окно вызывающего уже задано, - его восстанавливаем
+  void shadowRestore() {
+    uint8_t y0 = _scrollPage0 > OLED_SHADOW_FIRST ? _scrollPage0 : OLED_SHADOW_FIRST;
+    uint8_t y1 = _scrollPage1 < OLED_SHADOW_FIRST + _SHADOW_ROWS - 1 ? _scrollPage1 : OLED_SHADOW_FIRST + _SHADOW_ROWS - 1;
+    if (y0 > y1)
+      return; // прокручивали страницы без копии
+    bool known = !(_hwFlags & OLED_HW_UNKNOWN);
+    OledWindow window = _hw;
+#ifdef OLED_BUFFERED
+    bool toBuf = _toBuf;
+    _toBuf = false;
+#endif
+    setWindow(0, y0, _maxX, y1);
+    beginData();
+    for (uint8_t x = 0; x <= _maxX; x++)
+      for (uint8_t y = y0; y <= y1; y++)
+        sendByte(_shadow[(y - OLED_SHADOW_FIRST) * _TYPE::width + x]);
+    endTransm();
+#ifdef OLED_BUFFERED
+    _toBuf = toBuf;
+#endif
+    if (known)
+      setWindow(window.x0, window.y0, window.x1, window.y1);
+  }
+
+  uint8_t *shadowAt() {
+    uint8_t row = _hw.y - OLED_SHADOW_FIRST;
+    return row < _SHADOW_ROWS ? &_shadow[row * _TYPE::width + _hw.x] : nullptr;
+  }
+
+  uint8_t _shadow[_SHADOW_ROWS * _TYPE::width] = {}; // что сейчас в ОЗУ дисплея
+#endif
+  OledWindow _hw;                         // окно и указатель контроллера
+  uint8_t _hwFlags = OLED_HW_UNKNOWN;     // OLED_HW_* - состояние контроллера
+  uint8_t _contrast = 0x7F;
+  uint8_t _scrollPage0 = 0, _scrollPage1 = 0; // страницы, которые двигает прокрутка
+
+#ifdef OLED_ASYNC
+  static uint16_t queueNext(uint16_t i) { return i + 1 < OLED_QUEUE_SIZE ? i + 1 : 0; }
+
+  uint8_t _q[OLED_QUEUE_SIZE];
+  volatile uint16_t _qTail = 0;     // начало первой неотправленной транзакции
+  volatile uint16_t _qDone = 0;     // конец последней записанной целиком транзакции
+  uint16_t _qHead = 0;              // сюда пишется следующий байт
+  uint16_t _qStart = 0;             // байт длины текущей транзакции
+  uint8_t _qCount = 0;              // байт в текущей транзакции
+  volatile bool _qPolling = false;  // poll() уже работает
+  void (*_onDone)() = nullptr;
+  OledBus *_bus = nullptr;          // общая шина, если дисплей на ней
+#endif
 
   bool _invState = 0;
   bool _println = false;
+  bool _console = false; // console()
+  uint8_t _conTop = 0;   // страница ОЗУ, которая сейчас верхняя на экране
+  uint8_t _conStep = 1;  // страниц на строку консоли, делит 8
+#ifdef OLED_USE_BUFFER
+  bool _conMoved = false; // начальную строку отправит update()
+#endif
   bool _getn = false;
   uint8_t _scaleX = 1, _scaleY = 8;
   int _x = 0, _y = 0;
   uint8_t _shift = 0;
-  uint8_t _lastChar;
+  const OledFont *_font = nullptr; // setFont(), nullptr - встроенный
+  uint32_t _utf = 0;               // собираемый код UTF-8
+  uint8_t _utfState = 0;           // сколько байт продолжения UTF-8 еще ждем
   uint8_t _writes = 0;
   uint8_t _mode = 2;
+  bool _busOpen = false;
+#ifdef OLED_STATS
+  OledStats _stats = {};
+  uint8_t _statGroup = OLED_STAT_OTHER; // группа идущего вызова
+  bool _statData = false;               // открыта транзакция данных
+#endif
 };
 
-template <int _TYPE>
-inline uint8_t OledMini<_TYPE>::getCharMap(uint8_t font, uint8_t row) {
-#ifndef OLED_NO_PRINT
-  // шрифты для вывода текста
-  static constexpr uint8_t _charMap[][5] = {
-      {0x00, 0x00, 0x00, 0x00, 0x00}, //   0x20 32
-      {0x00, 0x00, 0x6f, 0x00, 0x00}, // ! 0x21 33
-      {0x00, 0x07, 0x00, 0x07, 0x00}, // " 0x22 34
-      {0x14, 0x7f, 0x14, 0x7f, 0x14}, // # 0x23 35
-      {0x8C, 0x92, 0xFF, 0x92, 0x62}, // $ 0x24 36
-      {0x23, 0x13, 0x08, 0x64, 0x62}, // % 0x25 37
-      {0x36, 0x49, 0x56, 0x20, 0x50}, // & 0x26 38
-      {0x00, 0x00, 0x07, 0x00, 0x00}, // ' 0x27 39
-      {0x00, 0x1c, 0x22, 0x41, 0x00}, // ( 0x28 40
-      {0x00, 0x41, 0x22, 0x1c, 0x00}, // ) 0x29 41
-      {0x14, 0x08, 0x3e, 0x08, 0x14}, // * 0x2a 42
-      {0x08, 0x08, 0x3e, 0x08, 0x08}, // + 0x2b 43
-      {0x00, 0x50, 0x30, 0x00, 0x00}, // , 0x2c 44
-      {0x08, 0x08, 0x08, 0x08, 0x08}, // - 0x2d 45
-      {0x00, 0x60, 0x60, 0x00, 0x00}, // . 0x2e 46
-      {0x20, 0x10, 0x08, 0x04, 0x02}, // / 0x2f 47
-      {0x3e, 0x51, 0x49, 0x45, 0x3e}, // 0 0x30 48
-      {0x00, 0x42, 0x7f, 0x40, 0x00}, // 1 0x31 49
-      {0x42, 0x61, 0x51, 0x49, 0x46}, // 2 0x32 50
-      {0x21, 0x41, 0x45, 0x4b, 0x31}, // 3 0x33 51
-      {0x18, 0x14, 0x12, 0x7f, 0x10}, // 4 0x34 52
-      {0x27, 0x45, 0x45, 0x45, 0x39}, // 5 0x35 53
-      {0x3c, 0x4a, 0x49, 0x49, 0x30}, // 6 0x36 54
-      {0x01, 0x71, 0x09, 0x05, 0x03}, // 7 0x37 55
-      {0x36, 0x49, 0x49, 0x49, 0x36}, // 8 0x38 56
-      {0x06, 0x49, 0x49, 0x29, 0x1e}, // 9 0x39 57
-      {0x00, 0x36, 0x36, 0x00, 0x00}, // : 0x3a 58
-      {0x00, 0x56, 0x36, 0x00, 0x00}, // ; 0x3b 59
-      {0x08, 0x14, 0x22, 0x41, 0x00}, // < 0x3c 60
-      {0x14, 0x14, 0x14, 0x14, 0x14}, // = 0x3d 61
-      {0x00, 0x41, 0x22, 0x14, 0x08}, // > 0x3e 62
-      {0x02, 0x01, 0x51, 0x09, 0x06}, // ? 0x3f 63
-      {0x3e, 0x41, 0x5d, 0x49, 0x4e}, // @ 0x40 64
-      {0x7e, 0x09, 0x09, 0x09, 0x7e}, // A 0x41 65
-      {0x7f, 0x49, 0x49, 0x49, 0x36}, // B 0x42 66
-      {0x3e, 0x41, 0x41, 0x41, 0x22}, // C 0x43 67
-      {0x7f, 0x41, 0x41, 0x41, 0x3e}, // D 0x44 68
-      {0x7f, 0x49, 0x49, 0x49, 0x41}, // E 0x45 69
-      {0x7f, 0x09, 0x09, 0x09, 0x01}, // F 0x46 70
-      {0x3e, 0x41, 0x49, 0x49, 0x7a}, // G 0x47 71
-      {0x7f, 0x08, 0x08, 0x08, 0x7f}, // H 0x48 72
-      {0x00, 0x41, 0x7f, 0x41, 0x00}, // I 0x49 73
-      {0x20, 0x40, 0x41, 0x3f, 0x01}, // J 0x4a 74
-      {0x7f, 0x08, 0x14, 0x22, 0x41}, // K 0x4b 75
-      {0x7f, 0x40, 0x40, 0x40, 0x40}, // L 0x4c 76
-      {0x7f, 0x02, 0x0c, 0x02, 0x7f}, // M 0x4d 77
-      {0x7f, 0x04, 0x08, 0x10, 0x7f}, // N 0x4e 78
-      {0x3e, 0x41, 0x41, 0x41, 0x3e}, // O 0x4f 79
-      {0x7f, 0x09, 0x09, 0x09, 0x06}, // P 0x50 80
-      {0x3e, 0x41, 0x51, 0x21, 0x5e}, // Q 0x51 81
-      {0x7f, 0x09, 0x19, 0x29, 0x46}, // R 0x52 82
-      {0x46, 0x49, 0x49, 0x49, 0x31}, // S 0x53 83
-      {0x01, 0x01, 0x7f, 0x01, 0x01}, // T 0x54 84
-      {0x3f, 0x40, 0x40, 0x40, 0x3f}, // U 0x55 85
-      {0x0f, 0x30, 0x40, 0x30, 0x0f}, // V 0x56 86
-      {0x3f, 0x40, 0x30, 0x40, 0x3f}, // W 0x57 87
-      {0x63, 0x14, 0x08, 0x14, 0x63}, // X 0x58 88
-      {0x07, 0x08, 0x70, 0x08, 0x07}, // Y 0x59 89
-      {0x61, 0x51, 0x49, 0x45, 0x43}, // Z 0x5a 90
-      {0x00, 0x00, 0x7f, 0x41, 0x00}, // [ 0x5b 91
-      {0x02, 0x04, 0x08, 0x10, 0x20}, // \ 0x5c 92
-      {0x00, 0x41, 0x7f, 0x00, 0x00}, // ] 0x5d 93
-      {0x04, 0x02, 0x01, 0x02, 0x04}, // ^ 0x5e 94
-      {0x40, 0x40, 0x40, 0x40, 0x40}, // _ 0x5f 95
-      {0x00, 0x00, 0x03, 0x04, 0x00}, // ` 0x60 96
-      {0x20, 0x54, 0x54, 0x54, 0x78}, // a 0x61 97
-      {0x7f, 0x48, 0x44, 0x44, 0x38}, // b 0x62 98
-      {0x38, 0x44, 0x44, 0x44, 0x20}, // c 0x63 99
-      {0x38, 0x44, 0x44, 0x48, 0x7f}, // d 0x64 100
-      {0x38, 0x54, 0x54, 0x54, 0x18}, // e 0x65 101
-      {0x08, 0x7e, 0x09, 0x01, 0x02}, // f 0x66 102
-      {0x0c, 0x52, 0x52, 0x52, 0x3e}, // g 0x67 103
-      {0x7f, 0x08, 0x04, 0x04, 0x78}, // h 0x68 104
-      {0x00, 0x44, 0x7d, 0x40, 0x00}, // i 0x69 105
-      {0x20, 0x40, 0x44, 0x3d, 0x00}, // j 0x6a 106
-      {0x00, 0x7f, 0x10, 0x28, 0x44}, // k 0x6b 107
-      {0x00, 0x41, 0x7f, 0x40, 0x00}, // l 0x6c 108
-      {0x7c, 0x04, 0x18, 0x04, 0x78}, // m 0x6d 109
-      {0x7c, 0x08, 0x04, 0x04, 0x78}, // n 0x6e 110
-      {0x38, 0x44, 0x44, 0x44, 0x38}, // o 0x6f 111
-      {0x7c, 0x14, 0x14, 0x14, 0x08}, // p 0x70 112
-      {0x08, 0x14, 0x14, 0x18, 0x7c}, // q 0x71 113
-      {0x7c, 0x08, 0x04, 0x04, 0x08}, // r 0x72 114
-      {0x48, 0x54, 0x54, 0x54, 0x20}, // s 0x73 115
-      {0x04, 0x3f, 0x44, 0x40, 0x20}, // t 0x74 116
-      {0x3c, 0x40, 0x40, 0x20, 0x7c}, // u 0x75 117
-      {0x1c, 0x20, 0x40, 0x20, 0x1c}, // v 0x76 118
-      {0x3c, 0x40, 0x30, 0x40, 0x3c}, // w 0x77 119
-      {0x44, 0x28, 0x10, 0x28, 0x44}, // x 0x78 120
-      {0x0c, 0x50, 0x50, 0x50, 0x3c}, // y 0x79 121
-      {0x44, 0x64, 0x54, 0x4c, 0x44}, // z 0x7a 122
-      {0x00, 0x08, 0x36, 0x41, 0x41}, // { 0x7b 123
-      {0x00, 0x00, 0x7f, 0x00, 0x00}, // | 0x7c 124
-      {0x41, 0x41, 0x36, 0x08, 0x00}, // } 0x7d 125
-      {0x04, 0x02, 0x04, 0x08, 0x04}  // ~ 0x7e 126
-#ifdef OLED_NO_RUS
-  };
-#else
-      ,
-      {0x7E, 0x11, 0x11, 0x11, 0x7E}, //__А (0xC0).
-      {0x7F, 0x49, 0x49, 0x49, 0x33}, //__Б (0xC1).
-      {0x7F, 0x49, 0x49, 0x49, 0x36}, //__В (0xC2).
-      {0x7F, 0x01, 0x01, 0x01, 0x03}, //__Г (0xC3).
-      {0xE0, 0x51, 0x4F, 0x41, 0xFF}, //__Д (0xC4).
-      {0x7F, 0x49, 0x49, 0x49, 0x41}, //__Е (0xC5).
-      {0x77, 0x08, 0x7F, 0x08, 0x77}, //__Ж (0xC6).
-      {0x41, 0x49, 0x49, 0x49, 0x36}, //__З (0xC7).
-      {0x7F, 0x10, 0x08, 0x04, 0x7F}, //__И (0xC8).
-      {0x7C, 0x21, 0x12, 0x09, 0x7C}, //__Й (0xC9).
-      {0x7F, 0x08, 0x14, 0x22, 0x41}, //__К (0xCA).
-      {0x20, 0x41, 0x3F, 0x01, 0x7F}, //__Л (0xCB).
-      {0x7F, 0x02, 0x0C, 0x02, 0x7F}, //__М (0xCC).
-      {0x7F, 0x08, 0x08, 0x08, 0x7F}, //__Н (0xCD).
-      {0x3E, 0x41, 0x41, 0x41, 0x3E}, //__О (0xCE).
-      {0x7F, 0x01, 0x01, 0x01, 0x7F}, //__П (0xCF).
-      {0x7F, 0x09, 0x09, 0x09, 0x06}, //__Р (0xD0).
-      {0x3E, 0x41, 0x41, 0x41, 0x22}, //__С (0xD1).
-      {0x01, 0x01, 0x7F, 0x01, 0x01}, //__Т (0xD2).
-      {0x47, 0x28, 0x10, 0x08, 0x07}, //__У (0xD3).
-      {0x1C, 0x22, 0x7F, 0x22, 0x1C}, //__Ф (0xD4).
-      {0x63, 0x14, 0x08, 0x14, 0x63}, //__Х (0xD5).
-      {0x7F, 0x40, 0x40, 0x40, 0xFF}, //__Ц (0xD6).
-      {0x07, 0x08, 0x08, 0x08, 0x7F}, //__Ч (0xD7).
-      {0x7F, 0x40, 0x7F, 0x40, 0x7F}, //__Ш (0xD8).
-      {0x7F, 0x40, 0x7F, 0x40, 0xFF}, //__Щ (0xD9).
-      {0x01, 0x7F, 0x48, 0x48, 0x30}, //__Ъ (0xDA).
-      {0x7F, 0x48, 0x30, 0x00, 0x7F}, //__Ы (0xDB).
-      {0x00, 0x7F, 0x48, 0x48, 0x30}, //__Ь (0xDC).
-      {0x22, 0x41, 0x49, 0x49, 0x3E}, //__Э (0xDD).
-      {0x7F, 0x08, 0x3E, 0x41, 0x3E}, //__Ю (0xDE).
-      {0x46, 0x29, 0x19, 0x09, 0x7F}, //__Я (0xDF).
-
-      {0x20, 0x54, 0x54, 0x54, 0x78}, //__а (0xE0).
-      {0x3C, 0x4A, 0x4A, 0x49, 0x31}, //__б (0xE1).
-      {0x7C, 0x54, 0x54, 0x28, 0x00}, //__в (0xE2).
-      {0x7C, 0x04, 0x04, 0x0C, 0x00}, //__г (0xE3).
-      {0xE0, 0x54, 0x4C, 0x44, 0xFC}, //__д (0xE4).
-      {0x38, 0x54, 0x54, 0x54, 0x18}, //__е (0xE5).
-      {0x6C, 0x10, 0x7C, 0x10, 0x6C}, //__ж (0xE6).
-      {0x44, 0x54, 0x54, 0x28, 0x00}, //__з (0xE7).
-      {0x7C, 0x20, 0x10, 0x08, 0x7C}, //__и (0xE8).
-      {0x78, 0x42, 0x24, 0x12, 0x78}, //__й (0xE9).
-      {0x7C, 0x10, 0x28, 0x44, 0x00}, //__к (0xEA).
-      {0x20, 0x44, 0x3C, 0x04, 0x7C}, //__л (0xEB).
-      {0x7C, 0x08, 0x10, 0x08, 0x7C}, //__м (0xEC).
-      {0x7C, 0x10, 0x10, 0x10, 0x7C}, //__н (0xED).
-      {0x38, 0x44, 0x44, 0x44, 0x38}, //__о (0xEE).
-      {0x7C, 0x04, 0x04, 0x04, 0x7C}, //__п (0xEF).
-      {0x7C, 0x14, 0x14, 0x14, 0x08}, //__р (0xF0).
-      {0x38, 0x44, 0x44, 0x44, 0x00}, //__с (0xF1).
-      {0x04, 0x04, 0x7C, 0x04, 0x04}, //__т (0xF2).
-      {0x0C, 0x50, 0x50, 0x50, 0x3C}, //__у (0xF3).
-      {0x30, 0x48, 0xFE, 0x48, 0x30}, //__ф (0xF4).
-      {0x44, 0x28, 0x10, 0x28, 0x44}, //__х (0xF5).
-      {0x7C, 0x40, 0x40, 0x7C, 0xC0}, //__ц (0xF6).
-      {0x0C, 0x10, 0x10, 0x10, 0x7C}, //__ч (0xF7).
-      {0x7C, 0x40, 0x7C, 0x40, 0x7C}, //__ш (0xF8).
-      {0x7C, 0x40, 0x7C, 0x40, 0xFC}, //__щ (0xF9).
-      {0x04, 0x7C, 0x50, 0x50, 0x20}, //__ъ (0xFA).
-      {0x7C, 0x50, 0x50, 0x20, 0x7C}, //__ы (0xFB).
-      {0x7C, 0x50, 0x50, 0x20, 0x00}, //__ь (0xFC).
-      {0x28, 0x44, 0x54, 0x54, 0x38}, //__э (0xFD).
-      {0x7C, 0x10, 0x38, 0x44, 0x38}, //__ю (0xFE).
-      {0x08, 0x54, 0x34, 0x14, 0x7C}, //__я (0xFF).
-      {0x38, 0x55, 0x54, 0x55, 0x18}, //__ё (0xFF).
-  };
-#endif // OLED_NO_RUS
-#endif // OLED_NO_PRINT
+//==============================================================================
+// Числовое поле на WIDTH знакомест в точке (x, y пиксели) с масштабом scale.
+// Помнит выведенные символы и при новом значении перерисовывает только
+// изменившиеся: у тикающего счетчика это обычно одна последняя цифра.
+//   OledField<OledMini<SSD1306_128x64>, 5> volts(oled, 0, 16, 2);
+//   volts.print(1234, 2); // "12.34" с выравниванием вправо
+// Курсор и масштаб дисплея поле оставляет своими.
+//------------------------------------------------------------------------------
+template <typename OLED, uint8_t WIDTH>
+class OledField {
+  public:
+  OledField(OLED &oled, int x, int y, uint8_t scale = 1) : _oled(oled), _x(x), _y(y), _scale(scale) {}
+
+  // вывести число с decimals (до OLED_DECIMALS_MAX) знаками после точки,
+  // выравнивание вправо. Не влезает в поле - поле заполняется '#'
+  void print(int32_t value, uint8_t decimals = 0) {
+    char text[WIDTH];
+    uint8_t i = 0;
+    auto put = [&](char c) { // символ слева направо
+      if (i < WIDTH)
+        text[i++] = c;
+    };
+    uint32_t v = value < 0 ? 0UL - (uint32_t)value : value;
+    if (oledFormat(put, v, value < 0 ? '-' : 0, decimals, WIDTH) > WIDTH)
+      memset(text, '#', WIDTH); // не влезло
+    print(text);
+  }
+
+  // вывести ровно WIDTH символов text (латиница и цифры)
+  void print(const char *text) {
+    _oled.setScale(_scale);
+    for (uint8_t i = 0; i < WIDTH;) {
+      if (text[i] == _last[i]) {
+        i++;
+        continue;
+      }
+      uint8_t n = 0; // подряд идущие изменившиеся символы выводим одним окном
+      while (i + n < WIDTH && text[i + n] != _last[i + n]) {
+        _last[i + n] = text[i + n];
+        n++;
+      }
+      _oled.setCursorXY(_x + i * 6 * _scale, _y);
+      _oled.write((const uint8_t *)text + i, n);
+      i += n;
+    }
+  }
+
+  // забыть выведенное - следующий print() перерисует поле целиком
+  void invalidate() { memset(_last, 0, WIDTH); }
+
+  private:
+  OLED &_oled;
+  int _x, _y;
+  uint8_t _scale;
+  char _last[WIDTH] = {};
+};
+
+//==============================================================================
+// Проигрыватель анимации OledAnim (делает extras/tools/oledanim.py): первый
+// кадр целиком, дальше в каждом кадре только изменившиеся прямоугольники.
+//   OledAnimPlayer<OledMini<SSD1306_128x64>> spinner(oled, SPINNER, 48, 2, 100);
+//   spinner.tick(millis()); // в главном цикле, сам решает, пора ли кадр
+// Формат: ширина и высота в пикселях, число кадров, первый кадр в OledPack
+// (без заголовка), затем для кадров 1..N-1 и перехода N-1 -> 0: число
+// прямоугольников и для каждого столбик, страница, ширина, высота в страницах
+// и его байты в OledPack. Анимация ставится на страницу (row) и должна целиком
+// помещаться на экране.
+//------------------------------------------------------------------------------
+template <typename OLED>
+class OledAnimPlayer {
+  public:
+  OledAnimPlayer(OLED &oled, const uint8_t *anim, int x, uint8_t row, uint16_t period)
+      : _oled(oled), _anim(anim), _x(x), _row(row), _period(period) {}
+
+  // вывести следующий кадр, если подошло его время (now - в мс от любого
+  // счетчика). Не ждет: рано - сразу false. С OLED_ASYNC кадр не ставится,
+  // пока не ушел предыдущий. Отстав больше чем на кадр, счет времени
+  // начинается заново, а не догоняет пропущенное
+  bool tick(uint32_t now) {
+    if (_next && (int32_t)(now - _due) < 0)
+      return false;
+#ifdef OLED_ASYNC
+    if (_oled.busy())
+      return false;
+#endif
+    _due = (_next && (int32_t)(now - _due) < _period) ? _due + _period : now + _period;
+    if (!_next)
+      drawKey();
+    else
+      drawDelta();
+    return true;
+  }
+
+  // начать сначала: следующий tick() выведет первый кадр целиком
+  // (например, после clear())
+  void restart() { _next = nullptr; }
+
+  // номер кадра на экране
+  uint8_t frame() { return _frame; }
+
+  private:
+  // первый кадр целиком
+  void drawKey() {
+    uint8_t pages = (_anim[1] + 7) >> 3;
+    OledUnpack src{_anim + 3};
+    send(src, 0, 0, _anim[0], pages);
+    _next = _first = src.p; // дальше - кадр 1
+    _frame = 0;
+  }
+
+  // разница с предыдущим кадром
+  void drawDelta() {
+    OledUnpack src{_next};
+    uint8_t rects = *src.p++;
+    while (rects--) {
+      uint8_t col = *src.p++, page = *src.p++, width = *src.p++, pages = *src.p++;
+      send(src, col, page, width, pages);
+    }
+    if (++_frame >= _anim[2]) { // это был переход к кадру 0
+      _frame = 0;
+      _next = _first;
+    } else {
+      _next = src.p;
+    }
+  }
+
+  // прямоугольник width x pages байт из src в окно анимации
+  void send(OledUnpack &src, uint8_t col, uint8_t page, uint8_t width, uint8_t pages) {
+    int x0 = _x + col, y0 = _row + page;
+    _oled.setWindow(x0, y0, x0 + width - 1, y0 + pages - 1);
+    _oled.beginData();
+    for (uint16_t n = width * pages; n; n--)
+      _oled.sendByte(src.read(0, 0));
+    _oled.endTransm();
+  }
+
+  OLED &_oled;
+  const uint8_t *_anim;
+  const uint8_t *_next = nullptr;  // разница следующего кадра, nullptr - нужен первый кадр
+  const uint8_t *_first = nullptr; // разница кадра 1 - с нее начинается новый круг
+  int _x;
+  uint8_t _row;
+  uint16_t _period;
+  uint32_t _due = 0;
+  uint8_t _frame = 0;
+};
+
+// шрифты для вывода текста: ASCII 0x20-0x7E и кириллица отдельно, чтобы
+// без OLED_TEXT_RUS во флеш попадала только первая таблица
+inline constexpr uint8_t _oled_charMap[][5] = {
+    {0x00, 0x00, 0x00, 0x00, 0x00}, //   0x20 32
+    {0x00, 0x00, 0x6f, 0x00, 0x00}, // ! 0x21 33
+    {0x00, 0x07, 0x00, 0x07, 0x00}, // " 0x22 34
+    {0x14, 0x7f, 0x14, 0x7f, 0x14}, // # 0x23 35
+    {0x8C, 0x92, 0xFF, 0x92, 0x62}, // $ 0x24 36
+    {0x23, 0x13, 0x08, 0x64, 0x62}, // % 0x25 37
+    {0x36, 0x49, 0x56, 0x20, 0x50}, // & 0x26 38
+    {0x00, 0x00, 0x07, 0x00, 0x00}, // ' 0x27 39
+    {0x00, 0x1c, 0x22, 0x41, 0x00}, // ( 0x28 40
+    {0x00, 0x41, 0x22, 0x1c, 0x00}, // ) 0x29 41
+    {0x14, 0x08, 0x3e, 0x08, 0x14}, // * 0x2a 42
+    {0x08, 0x08, 0x3e, 0x08, 0x08}, // + 0x2b 43
+    {0x00, 0x50, 0x30, 0x00, 0x00}, // , 0x2c 44
+    {0x08, 0x08, 0x08, 0x08, 0x08}, // - 0x2d 45
+    {0x00, 0x60, 0x60, 0x00, 0x00}, // . 0x2e 46
+    {0x20, 0x10, 0x08, 0x04, 0x02}, // / 0x2f 47
+    {0x3e, 0x51, 0x49, 0x45, 0x3e}, // 0 0x30 48
+    {0x00, 0x42, 0x7f, 0x40, 0x00}, // 1 0x31 49
+    {0x42, 0x61, 0x51, 0x49, 0x46}, // 2 0x32 50
+    {0x21, 0x41, 0x45, 0x4b, 0x31}, // 3 0x33 51
+    {0x18, 0x14, 0x12, 0x7f, 0x10}, // 4 0x34 52
+    {0x27, 0x45, 0x45, 0x45, 0x39}, // 5 0x35 53
+    {0x3c, 0x4a, 0x49, 0x49, 0x30}, // 6 0x36 54
+    {0x01, 0x71, 0x09, 0x05, 0x03}, // 7 0x37 55
+    {0x36, 0x49, 0x49, 0x49, 0x36}, // 8 0x38 56
+    {0x06, 0x49, 0x49, 0x29, 0x1e}, // 9 0x39 57
+    {0x00, 0x36, 0x36, 0x00, 0x00}, // : 0x3a 58
+    {0x00, 0x56, 0x36, 0x00, 0x00}, // ; 0x3b 59
+    {0x08, 0x14, 0x22, 0x41, 0x00}, // < 0x3c 60
+    {0x14, 0x14, 0x14, 0x14, 0x14}, // = 0x3d 61
+    {0x00, 0x41, 0x22, 0x14, 0x08}, // > 0x3e 62
+    {0x02, 0x01, 0x51, 0x09, 0x06}, // ? 0x3f 63
+    {0x3e, 0x41, 0x5d, 0x49, 0x4e}, // @ 0x40 64
+    {0x7e, 0x09, 0x09, 0x09, 0x7e}, // A 0x41 65
+    {0x7f, 0x49, 0x49, 0x49, 0x36}, // B 0x42 66
+    {0x3e, 0x41, 0x41, 0x41, 0x22}, // C 0x43 67
+    {0x7f, 0x41, 0x41, 0x41, 0x3e}, // D 0x44 68
+    {0x7f, 0x49, 0x49, 0x49, 0x41}, // E 0x45 69
+    {0x7f, 0x09, 0x09, 0x09, 0x01}, // F 0x46 70
+    {0x3e, 0x41, 0x49, 0x49, 0x7a}, // G 0x47 71
+    {0x7f, 0x08, 0x08, 0x08, 0x7f}, // H 0x48 72
+    {0x00, 0x41, 0x7f, 0x41, 0x00}, // I 0x49 73
+    {0x20, 0x40, 0x41, 0x3f, 0x01}, // J 0x4a 74
+    {0x7f, 0x08, 0x14, 0x22, 0x41}, // K 0x4b 75
+    {0x7f, 0x40, 0x40, 0x40, 0x40}, // L 0x4c 76
+    {0x7f, 0x02, 0x0c, 0x02, 0x7f}, // M 0x4d 77
+    {0x7f, 0x04, 0x08, 0x10, 0x7f}, // N 0x4e 78
+    {0x3e, 0x41, 0x41, 0x41, 0x3e}, // O 0x4f 79
+    {0x7f, 0x09, 0x09, 0x09, 0x06}, // P 0x50 80
+    {0x3e, 0x41, 0x51, 0x21, 0x5e}, // Q 0x51 81
+    {0x7f, 0x09, 0x19, 0x29, 0x46}, // R 0x52 82
+    {0x46, 0x49, 0x49, 0x49, 0x31}, // S 0x53 83
+    {0x01, 0x01, 0x7f, 0x01, 0x01}, // T 0x54 84
+    {0x3f, 0x40, 0x40, 0x40, 0x3f}, // U 0x55 85
+    {0x0f, 0x30, 0x40, 0x30, 0x0f}, // V 0x56 86
+    {0x3f, 0x40, 0x30, 0x40, 0x3f}, // W 0x57 87
+    {0x63, 0x14, 0x08, 0x14, 0x63}, // X 0x58 88
+    {0x07, 0x08, 0x70, 0x08, 0x07}, // Y 0x59 89
+    {0x61, 0x51, 0x49, 0x45, 0x43}, // Z 0x5a 90
+    {0x00, 0x00, 0x7f, 0x41, 0x00}, // [ 0x5b 91
+    {0x02, 0x04, 0x08, 0x10, 0x20}, // \ 0x5c 92
+    {0x00, 0x41, 0x7f, 0x00, 0x00}, // ] 0x5d 93
+    {0x04, 0x02, 0x01, 0x02, 0x04}, // ^ 0x5e 94
+    {0x40, 0x40, 0x40, 0x40, 0x40}, // _ 0x5f 95
+    {0x00, 0x00, 0x03, 0x04, 0x00}, // ` 0x60 96
+    {0x20, 0x54, 0x54, 0x54, 0x78}, // a 0x61 97
+    {0x7f, 0x48, 0x44, 0x44, 0x38}, // b 0x62 98
+    {0x38, 0x44, 0x44, 0x44, 0x20}, // c 0x63 99
+    {0x38, 0x44, 0x44, 0x48, 0x7f}, // d 0x64 100
+    {0x38, 0x54, 0x54, 0x54, 0x18}, // e 0x65 101
+    {0x08, 0x7e, 0x09, 0x01, 0x02}, // f 0x66 102
+    {0x0c, 0x52, 0x52, 0x52, 0x3e}, // g 0x67 103
+    {0x7f, 0x08, 0x04, 0x04, 0x78}, // h 0x68 104
+    {0x00, 0x44, 0x7d, 0x40, 0x00}, // i 0x69 105
+    {0x20, 0x40, 0x44, 0x3d, 0x00}, // j 0x6a 106
+    {0x00, 0x7f, 0x10, 0x28, 0x44}, // k 0x6b 107
+    {0x00, 0x41, 0x7f, 0x40, 0x00}, // l 0x6c 108
+    {0x7c, 0x04, 0x18, 0x04, 0x78}, // m 0x6d 109
+    {0x7c, 0x08, 0x04, 0x04, 0x78}, // n 0x6e 110
+    {0x38, 0x44, 0x44, 0x44, 0x38}, // o 0x6f 111
+    {0x7c, 0x14, 0x14, 0x14, 0x08}, // p 0x70 112
+    {0x08, 0x14, 0x14, 0x18, 0x7c}, // q 0x71 113
+    {0x7c, 0x08, 0x04, 0x04, 0x08}, // r 0x72 114
+    {0x48, 0x54, 0x54, 0x54, 0x20}, // s 0x73 115
+    {0x04, 0x3f, 0x44, 0x40, 0x20}, // t 0x74 116
+    {0x3c, 0x40, 0x40, 0x20, 0x7c}, // u 0x75 117
+    {0x1c, 0x20, 0x40, 0x20, 0x1c}, // v 0x76 118
+    {0x3c, 0x40, 0x30, 0x40, 0x3c}, // w 0x77 119
+    {0x44, 0x28, 0x10, 0x28, 0x44}, // x 0x78 120
+    {0x0c, 0x50, 0x50, 0x50, 0x3c}, // y 0x79 121
+    {0x44, 0x64, 0x54, 0x4c, 0x44}, // z 0x7a 122
+    {0x00, 0x08, 0x36, 0x41, 0x41}, // { 0x7b 123
+    {0x00, 0x00, 0x7f, 0x00, 0x00}, // | 0x7c 124
+    {0x41, 0x41, 0x36, 0x08, 0x00}, // } 0x7d 125
+    {0x04, 0x02, 0x04, 0x08, 0x04}  // ~ 0x7e 126
+};
+
+inline constexpr uint8_t _oled_charMapRus[][5] = {
+    {0x7E, 0x11, 0x11, 0x11, 0x7E}, //__А (0xC0).
+    {0x7F, 0x49, 0x49, 0x49, 0x33}, //__Б (0xC1).
+    {0x7F, 0x49, 0x49, 0x49, 0x36}, //__В (0xC2).
+    {0x7F, 0x01, 0x01, 0x01, 0x03}, //__Г (0xC3).
+    {0xE0, 0x51, 0x4F, 0x41, 0xFF}, //__Д (0xC4).
+    {0x7F, 0x49, 0x49, 0x49, 0x41}, //__Е (0xC5).
+    {0x77, 0x08, 0x7F, 0x08, 0x77}, //__Ж (0xC6).
+    {0x41, 0x49, 0x49, 0x49, 0x36}, //__З (0xC7).
+    {0x7F, 0x10, 0x08, 0x04, 0x7F}, //__И (0xC8).
+    {0x7C, 0x21, 0x12, 0x09, 0x7C}, //__Й (0xC9).
+    {0x7F, 0x08, 0x14, 0x22, 0x41}, //__К (0xCA).
+    {0x20, 0x41, 0x3F, 0x01, 0x7F}, //__Л (0xCB).
+    {0x7F, 0x02, 0x0C, 0x02, 0x7F}, //__М (0xCC).
+    {0x7F, 0x08, 0x08, 0x08, 0x7F}, //__Н (0xCD).
+    {0x3E, 0x41, 0x41, 0x41, 0x3E}, //__О (0xCE).
+    {0x7F, 0x01, 0x01, 0x01, 0x7F}, //__П (0xCF).
+    {0x7F, 0x09, 0x09, 0x09, 0x06}, //__Р (0xD0).
+    {0x3E, 0x41, 0x41, 0x41, 0x22}, //__С (0xD1).
+    {0x01, 0x01, 0x7F, 0x01, 0x01}, //__Т (0xD2).
+    {0x47, 0x28, 0x10, 0x08, 0x07}, //__У (0xD3).
+    {0x1C, 0x22, 0x7F, 0x22, 0x1C}, //__Ф (0xD4).
+    {0x63, 0x14, 0x08, 0x14, 0x63}, //__Х (0xD5).
+    {0x7F, 0x40, 0x40, 0x40, 0xFF}, //__Ц (0xD6).
+    {0x07, 0x08, 0x08, 0x08, 0x7F}, //__Ч (0xD7).
+    {0x7F, 0x40, 0x7F, 0x40, 0x7F}, //__Ш (0xD8).
+    {0x7F, 0x40, 0x7F, 0x40, 0xFF}, //__Щ (0xD9).
+    {0x01, 0x7F, 0x48, 0x48, 0x30}, //__Ъ (0xDA).
+    {0x7F, 0x48, 0x30, 0x00, 0x7F}, //__Ы (0xDB).
+    {0x00, 0x7F, 0x48, 0x48, 0x30}, //__Ь (0xDC).
+    {0x22, 0x41, 0x49, 0x49, 0x3E}, //__Э (0xDD).
+    {0x7F, 0x08, 0x3E, 0x41, 0x3E}, //__Ю (0xDE).
+    {0x46, 0x29, 0x19, 0x09, 0x7F}, //__Я (0xDF).
+
+    {0x20, 0x54, 0x54, 0x54, 0x78}, //__а (0xE0).
+    {0x3C, 0x4A, 0x4A, 0x49, 0x31}, //__б (0xE1).
+    {0x7C, 0x54, 0x54, 0x28, 0x00}, //__в (0xE2).
+    {0x7C, 0x04, 0x04, 0x0C, 0x00}, //__г (0xE3).
+    {0xE0, 0x54, 0x4C, 0x44, 0xFC}, //__д (0xE4).
+    {0x38, 0x54, 0x54, 0x54, 0x18}, //__е (0xE5).
+    {0x6C, 0x10, 0x7C, 0x10, 0x6C}, //__ж (0xE6).
+    {0x44, 0x54, 0x54, 0x28, 0x00}, //__з (0xE7).
+    {0x7C, 0x20, 0x10, 0x08, 0x7C}, //__и (0xE8).
+    {0x78, 0x42, 0x24, 0x12, 0x78}, //__й (0xE9).
+    {0x7C, 0x10, 0x28, 0x44, 0x00}, //__к (0xEA).
+    {0x20, 0x44, 0x3C, 0x04, 0x7C}, //__л (0xEB).
+    {0x7C, 0x08, 0x10, 0x08, 0x7C}, //__м (0xEC).
+    {0x7C, 0x10, 0x10, 0x10, 0x7C}, //__н (0xED).
+    {0x38, 0x44, 0x44, 0x44, 0x38}, //__о (0xEE).
+    {0x7C, 0x04, 0x04, 0x04, 0x7C}, //__п (0xEF).
+    {0x7C, 0x14, 0x14, 0x14, 0x08}, //__р (0xF0).
+    {0x38, 0x44, 0x44, 0x44, 0x00}, //__с (0xF1).
+    {0x04, 0x04, 0x7C, 0x04, 0x04}, //__т (0xF2).
+    {0x0C, 0x50, 0x50, 0x50, 0x3C}, //__у (0xF3).
+    {0x30, 0x48, 0xFE, 0x48, 0x30}, //__ф (0xF4).
+    {0x44, 0x28, 0x10, 0x28, 0x44}, //__х (0xF5).
+    {0x7C, 0x40, 0x40, 0x7C, 0xC0}, //__ц (0xF6).
+    {0x0C, 0x10, 0x10, 0x10, 0x7C}, //__ч (0xF7).
+    {0x7C, 0x40, 0x7C, 0x40, 0x7C}, //__ш (0xF8).
+    {0x7C, 0x40, 0x7C, 0x40, 0xFC}, //__щ (0xF9).
+    {0x04, 0x7C, 0x50, 0x50, 0x20}, //__ъ (0xFA).
+    {0x7C, 0x50, 0x50, 0x20, 0x7C}, //__ы (0xFB).
+    {0x7C, 0x50, 0x50, 0x20, 0x00}, //__ь (0xFC).
+    {0x28, 0x44, 0x54, 0x54, 0x38}, //__э (0xFD).
+    {0x7C, 0x10, 0x38, 0x44, 0x38}, //__ю (0xFE).
+    {0x08, 0x54, 0x34, 0x14, 0x7C}, //__я (0xFF).
+    {0x38, 0x55, 0x54, 0x55, 0x18}, //__ё (0xFF).
+};
+
+// значки из Latin-1 и знак номера - после кириллицы, с индекса 160
+inline constexpr uint8_t _oled_charMapSym[][5] = {
+    {0x00, 0x06, 0x09, 0x09, 0x06}, // ° 160
+    {0x44, 0x44, 0x5F, 0x44, 0x44}, // ± 161
+    {0x08, 0x14, 0x2A, 0x14, 0x22}, // « 162
+    {0x22, 0x14, 0x2A, 0x14, 0x08}, // » 163
+    {0x00, 0x14, 0x08, 0x14, 0x00}, // × 164
+    {0x08, 0x08, 0x2A, 0x08, 0x08}, // ÷ 165
+    {0xFC, 0x20, 0x20, 0x10, 0x3C}, // µ 166
+    {0x00, 0x00, 0x08, 0x00, 0x00}, // · 167
+    {0x00, 0x19, 0x15, 0x12, 0x00}, // ² 168
+    {0x00, 0x11, 0x15, 0x0A, 0x00}, // ³ 169
+    {0x7F, 0x06, 0x0C, 0x7F, 0x05}, // № 170
+};
+
+// индексы букв для таблиц ниже: ASCII, кириллица, значки, нет буквы
+#define OLED_G(c) ((c) - ' ')
+#define OLED_GR(code) ((code) - 0x410 + 95)
+#define OLED_GS(i) (160 + (i))
+#define OLED_GX 0xFF
+
+// Latin-1 0xA0-0xFF: значки и буквы без надстрочных знаков
+inline constexpr uint8_t _oled_mapLatin1[96] = {
+    OLED_G(' '), OLED_G('!'), OLED_G('c'), OLED_GX, OLED_GX, OLED_G('Y'), OLED_G('|'), OLED_GX,             // A0-A7
+    OLED_G('"'), OLED_GX, OLED_GX, OLED_GS(2), OLED_GX, OLED_G('-'), OLED_GX, OLED_GX,                      // A8-AF
+    OLED_GS(0), OLED_GS(1), OLED_GS(8), OLED_GS(9), OLED_G('\''), OLED_GS(6), OLED_GX, OLED_GS(7),          // B0-B7
+    OLED_G(','), OLED_GX, OLED_GX, OLED_GS(3), OLED_GX, OLED_GX, OLED_GX, OLED_G('?'),                      // B8-BF
+    OLED_G('A'), OLED_G('A'), OLED_G('A'), OLED_G('A'), OLED_G('A'), OLED_G('A'), OLED_GX, OLED_G('C'),     // C0-C7
+    OLED_G('E'), OLED_G('E'), OLED_G('E'), OLED_G('E'), OLED_G('I'), OLED_G('I'), OLED_G('I'), OLED_G('I'), // C8-CF
+    OLED_G('D'), OLED_G('N'), OLED_G('O'), OLED_G('O'), OLED_G('O'), OLED_G('O'), OLED_G('O'), OLED_GS(4),  // D0-D7
+    OLED_G('O'), OLED_G('U'), OLED_G('U'), OLED_G('U'), OLED_G('U'), OLED_G('Y'), OLED_GX, OLED_GX,         // D8-DF
+    OLED_G('a'), OLED_G('a'), OLED_G('a'), OLED_G('a'), OLED_G('a'), OLED_G('a'), OLED_GX, OLED_G('c'),     // E0-E7
+    OLED_G('e'), OLED_G('e'), OLED_G('e'), OLED_G('e'), OLED_G('i'), OLED_G('i'), OLED_G('i'), OLED_G('i'), // E8-EF
+    OLED_GX, OLED_G('n'), OLED_G('o'), OLED_G('o'), OLED_G('o'), OLED_G('o'), OLED_G('o'), OLED_GS(5),      // F0-F7
+    OLED_G('o'), OLED_G('u'), OLED_G('u'), OLED_G('u'), OLED_G('u'), OLED_G('y'), OLED_GX, OLED_G('y'),     // F8-FF
+};
+
+// кириллица 0x400-0x40F и 0x450-0x45F (А-я идут подряд и в таблице не нужны):
+// украинские, белорусские и сербские буквы - похожими русскими или латинскими
+inline constexpr uint8_t _oled_mapCyr[32] = {
+    OLED_GR(0x415), OLED_GR(0x415), OLED_GX, OLED_GR(0x413), OLED_GX, OLED_G('S'), OLED_G('I'), OLED_G('I'), // Ѐ Ё Ђ Ѓ Є Ѕ І Ї
+    OLED_G('J'), OLED_GX, OLED_GX, OLED_GX, OLED_GR(0x41A), OLED_GR(0x418), OLED_GR(0x423), OLED_GX,         // Ј Љ Њ Ћ Ќ Ѝ Ў Џ
+    OLED_GR(0x435), 159, OLED_GX, OLED_GR(0x433), OLED_GX, OLED_G('s'), OLED_G('i'), OLED_G('i'),            // ѐ ё ђ ѓ є ѕ і ї
+    OLED_G('j'), OLED_GX, OLED_GX, OLED_GX, OLED_GR(0x43A), OLED_GR(0x438), OLED_GR(0x443), OLED_GX,         // ј љ њ ћ ќ ѝ ў џ
+};
+
+// знаки 0x2010-0x201F: дефисы и тире - '-', кавычки - ASCII
+inline constexpr uint8_t _oled_mapPunct[16] = {
+    OLED_G('-'), OLED_G('-'), OLED_G('-'), OLED_G('-'), OLED_G('-'), OLED_G('-'), OLED_GX, OLED_GX,
+    OLED_G('\''), OLED_G('\''), OLED_G(','), OLED_G('\''), OLED_G('"'), OLED_G('"'), OLED_G('"'), OLED_G('"'),
+};
+
+// столбик буквы по сквозному индексу: 0-94 - ASCII, 95-159 - кириллица, дальше значки
+constexpr uint8_t oledGlyph(int glyph, uint8_t col) {
+  return glyph < 95 ? _oled_charMap[glyph][col] : glyph < 160 ? _oled_charMapRus[glyph - 95][col] : _oled_charMapSym[glyph - 160][col];
+}
+
+// сквозной индекс буквы по коду символа Unicode, -1 - такой буквы нет.
+// Без ветвлений по диапазонам: ASCII и А-я - сдвигом, остальное - таблицами
+// по блокам Unicode. RUS = false - без кириллицы (ее таблицы не нужны)
+template <bool RUS = true>
+constexpr int oledGlyphIndex(uint32_t code) {
+  uint8_t glyph = OLED_GX;
+  if (code - 0x20 < 0x5F)
+    return code - 0x20; // ASCII
+  if (code - 0xA0 < 0x60)
+    glyph = _oled_mapLatin1[code - 0xA0];
+  else if (code - 0x2010 < 0x10)
+    glyph = _oled_mapPunct[code - 0x2010];
+  else if (code == 0x2022)
+    glyph = OLED_GS(7); // • - точкой
+  else if (code == 0x2116)
+    glyph = OLED_GS(10); // №
+  if constexpr (RUS) {
+    if (code - 0x410 < 0x40)
+      return OLED_GR(code); // А-я
+    if (code - 0x400 < 0x60)
+      glyph = _oled_mapCyr[code < 0x410 ? code - 0x400 : code - 0x450 + 16];
+    else if (code - 0x490 < 2)
+      glyph = code == 0x490 ? OLED_GR(0x413) : OLED_GR(0x433); // Ґ ґ - Г г
+  }
+  return glyph == OLED_GX ? -1 : glyph;
+}
+
+// разобрать строку UTF-8 тем же автоматом _oled_utf8Next, что и printChar():
+// put(code) для каждого собранного символа, вместо оборванного - 0xFFFD
+template <typename PUT>
+constexpr void oledUtf8Decode(const char *str, PUT put) {
+  uint32_t code = 0;
+  uint8_t state = 0;
+  for (; *str; str++) {
+    uint8_t data = *str;
+    uint8_t type = _oled_utf8Class[data >> 4];
+    uint8_t next = _oled_utf8Next[state][type];
+    code = type == OLED_UTF8_CONT ? (code << 6) | (data & 0x3F) : data & (0xFF >> (type + 1));
+    state = next & 3;
+    if (next & OLED_UTF8_ERR)
+      put(0xFFFD);
+    if (next & OLED_UTF8_DONE)
+      put(code);
+  }
+}
+
+// буква надписи для символа code, как ее выберет printCode(): управляющие
+// символы не печатаются, вместо отсутствующих - OLED_FALLBACK, -1 - ничего
+template <bool RUS>
+constexpr int oledLabelGlyph(uint32_t code) {
+  if (code < 0x20)
+    return -1;
+  int glyph = oledGlyphIndex<RUS>(code);
+  return glyph < 0 ? oledGlyphIndex<RUS>(OLED_FALLBACK) : glyph;
+}
+
+// число столбиков строки в OLED_LABEL(): 6 на каждую выводимую букву
+template <bool RUS>
+constexpr size_t oledLabelSize(const char *str) {
+  size_t size = 0;
+  oledUtf8Decode(str, [&](uint32_t code) {
+    if (oledLabelGlyph<RUS>(code) >= 0)
+      size += 6;
+  });
+  return size;
+}
 
-  return (_charMap[font][row]);
+// закодировать строку в столбики букв так же, как ее напечатает print() с
+// набором букв RUS
+template <size_t N, bool RUS>
+constexpr OledLabel<N, RUS> oledLabel(const char *str) {
+  OledLabel<N, RUS> label{};
+  size_t i = 0;
+  oledUtf8Decode(str, [&](uint32_t code) {
+    int glyph = oledLabelGlyph<RUS>(code);
+    if (glyph < 0)
+      return;
+    for (uint8_t col = 0; col < 5; col++)
+      label.data[i + col] = oledGlyph(glyph, col);
+    i += 6; // шестой столбик - пробел между буквами
+  });
+  return label;
+}
+
+// строка, превращенная в столбики букв при компиляции. Во время работы шрифт
+// не разбирается, столбики лежат во флеше готовыми:
+//   static constexpr auto TEMP = OLED_LABEL("Темп.");
+//   oled.print(TEMP);
+// Буквы - из набора по умолчанию (OLED_NO_RUS), для дисплея с другим набором -
+// OLED_LABEL_TEXT(OLED_TEXT_LATIN, "Temp.")
+#define OLED_LABEL_TEXT(text, str) (oledLabel<oledLabelSize<(text) == OLED_TEXT_RUS>(str), (text) == OLED_TEXT_RUS>(str))
+#define OLED_LABEL(str) OLED_LABEL_TEXT(OLED_TEXT_DEFAULT, str)
+
+// ==================== НАБОР БУКВ OLED_FONT_SUBSET ====================
+// Файл от extras/tools/oledsubset.py определяет OLED_SUBSET_CHARS - строку UTF-8
+// со всеми символами, которые печатает прошивка. При компиляции из полного
+// шрифта выбираются только их буквы, таблицы полного шрифта во флеш не идут.
+// Символ без буквы в шрифте - ошибка сборки с его кодом в OledSubsetMissing<>.
+// Буквы - из набора по умолчанию: с OLED_NO_RUS кириллица в набор не входит
+// и печатается как OLED_FALLBACK, как и с полным шрифтом
+#ifdef OLED_FONT_SUBSET
+#include OLED_FONT_SUBSET
+
+#define OLED_SUBSET_MAX 255 // больше разных символов в наборе нельзя
+
+// разбор OLED_SUBSET_CHARS при компиляции
+struct OledSubsetInfo {
+  uint16_t codes[OLED_SUBSET_MAX]; // коды символов по возрастанию, без повторов
+  int16_t glyphs[OLED_SUBSET_MAX]; // их сквозные индексы по возрастанию, без повторов
+  uint16_t nCodes, nGlyphs;
+  uint32_t missing; // первый символ без буквы в шрифте, 0 - все есть
+};
+
+// вставить value в упорядоченный массив без повторов
+template <typename T>
+constexpr void oledSubsetInsert(T *list, uint16_t &size, T value) {
+  uint16_t i = 0;
+  while (i < size && list[i] < value)
+    i++;
+  if (i < size && list[i] == value)
+    return;
+  for (uint16_t j = size; j > i; j--)
+    list[j] = list[j - 1];
+  list[i] = value;
+  size++;
+}
+
+template <bool RUS>
+constexpr OledSubsetInfo oledSubsetInfo(const char *str) {
+  OledSubsetInfo info{};
+  oledUtf8Decode(str, [&](uint32_t code) {
+    if (code < 0x20)
+      return;
+    int glyph = oledGlyphIndex<RUS>(code);
+    if (glyph < 0 && oledGlyphIndex<true>(code) >= 0)
+      return; // буква есть только в кириллице, а набор без нее
+    if (glyph < 0 || info.nCodes == OLED_SUBSET_MAX) {
+      if (!info.missing)
+        info.missing = code;
+      return;
+    }
+    oledSubsetInsert<uint16_t>(info.codes, info.nCodes, code);
+    oledSubsetInsert<int16_t>(info.glyphs, info.nGlyphs, glyph);
+  });
+  return info;
+}
+
+// урезанный шрифт: M кодов символов и N букв (похожие символы - одна буква)
+template <size_t M, size_t N>
+struct OledSubset {
+  uint16_t codes[M]; // коды символов по возрастанию
+  uint8_t rows[M];   // номер буквы в map для каждого кода
+  uint8_t map[N][5]; // столбики букв
+};
+
+template <bool RUS, size_t M, size_t N>
+constexpr OledSubset<M, N> oledSubset(const OledSubsetInfo &info) {
+  OledSubset<M, N> set{};
+  for (size_t i = 0; i < N; i++)
+    for (uint8_t col = 0; col < 5; col++)
+      set.map[i][col] = oledGlyph(info.glyphs[i], col);
+  for (size_t i = 0; i < M; i++) {
+    int glyph = oledGlyphIndex<RUS>(info.codes[i]);
+    uint8_t row = 0;
+    while (info.glyphs[row] != glyph)
+      row++;
+    set.codes[i] = info.codes[i];
+    set.rows[i] = row;
+  }
+  return set;
+}
+
+// номер буквы для кода двоичным поиском, -1 - символа нет в наборе
+template <size_t M, size_t N>
+constexpr int oledSubsetRow(const OledSubset<M, N> &set, uint32_t code) {
+  uint8_t lo = 0, hi = M;
+  while (lo < hi) {
+    uint8_t mid = (lo + hi) >> 1;
+    if (set.codes[mid] < code)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo < M && set.codes[lo] == code ? set.rows[lo] : -1;
+}
+
+template <uint32_t CODE>
+struct OledSubsetMissing; // определен только для 0: иначе ошибка сборки покажет код
+template <>
+struct OledSubsetMissing<0> {};
+
+#define OLED_SUBSET_RUS (OLED_TEXT_DEFAULT == OLED_TEXT_RUS)
+inline constexpr OledSubsetInfo _oled_subsetInfo = oledSubsetInfo<OLED_SUBSET_RUS>(OLED_SUBSET_CHARS);
+static_assert(sizeof(OledSubsetMissing<_oled_subsetInfo.missing>), "OLED_SUBSET_CHARS: символа нет в шрифте");
+static_assert(_oled_subsetInfo.nCodes, "OLED_SUBSET_CHARS пустой");
+inline constexpr auto _oled_subset = oledSubset<OLED_SUBSET_RUS, _oled_subsetInfo.nCodes, _oled_subsetInfo.nGlyphs>(_oled_subsetInfo);
+static_assert(OLED_FALLBACK == 0 || oledSubsetRow(_oled_subset, OLED_FALLBACK) >= 0,
+              "OLED_SUBSET_CHARS без символа OLED_FALLBACK - oledsubset.py --fallback");
+
+template <typename _TYPE, typename _FEAT>
+inline uint8_t OledMini<_TYPE, _FEAT>::getCharMapSubset(uint8_t font, uint8_t row) {
+  return _oled_subset.map[font][row];
+}
+#endif
+
+template <typename _TYPE, typename _FEAT>
+inline uint8_t OledMini<_TYPE, _FEAT>::getCharMap(uint8_t font, uint8_t row) {
+  return _oled_charMap[font][row];
+}
+
+template <typename _TYPE, typename _FEAT>
+inline uint8_t OledMini<_TYPE, _FEAT>::getCharMapRus(uint8_t font, uint8_t row) {
+  return _oled_charMapRus[font][row];
+}
+
+template <typename _TYPE, typename _FEAT>
+inline uint8_t OledMini<_TYPE, _FEAT>::getCharMapSym(uint8_t font, uint8_t row) {
+  return _oled_charMapSym[font][row];
+}
+
+template <typename _TYPE, typename _FEAT>
+inline int OledMini<_TYPE, _FEAT>::glyphIndex(uint32_t code) {
+#ifdef OLED_FONT_SUBSET
+  static_assert(_FEAT::text == OLED_TEXT_NONE || (_FEAT::text == OLED_TEXT_RUS) == OLED_SUBSET_RUS,
+                "OLED_FONT_SUBSET собран для набора букв по умолчанию (OLED_NO_RUS)");
+  constexpr int fallback = oledSubsetRow(_oled_subset, OLED_FALLBACK);
+  int glyph = oledSubsetRow(_oled_subset, code);
+  return glyph < 0 ? fallback : glyph;
+#else
+  constexpr bool rus = _FEAT::text == OLED_TEXT_RUS;
+  constexpr int fallback = oledGlyphIndex<rus>(OLED_FALLBACK);
+  int glyph = oledGlyphIndex<rus>(code);
+  return glyph < 0 ? fallback : glyph;
+#endif
 }